@@ -521,8 +521,11 @@ rfc5444_writer_forward_msg(
   }
 
   /* 2.) generate message and do non-target specific post processors */
+  if (len > sizeof(_msg_buffer)) {
+    return RFC5444_FW_MESSAGE_TOO_LONG;
+  }
   ptr = _msg_buffer;
-  memcpy(ptr, writer->_msg.buffer, len);
+  memcpy(ptr, msg, len);
 
   /* remember length */
   generic_size = len;
@@ -576,9 +579,9 @@ rfc5444_writer_forward_msg(
     ptr =
       &target->_pkt.buffer[target->_pkt.header + target->_pkt.added + target->_pkt.allocated + target->_bin_msgs_size];
 
-    /* copy message into packet buffer */
+    /* copy processed message into packet buffer */
     assert(ptr + generic_size <= target->_pkt.buffer + target->_pkt.max);
-    memcpy(ptr, msg, generic_size);
+    memcpy(ptr, _msg_buffer, generic_size);
 
     /* remember position of first copy */
     msg_size = generic_size;
@@ -621,6 +624,83 @@ rfc5444_writer_forward_msg(
   return RFC5444_OKAY;
 }
 
+/**
+ * Write an already encoded rfc5444 message into the packet buffers
+ * of the selected targets, flushing them when the message does not fit.
+ * Message post-processors are not applied, so the message is rejected
+ * when one of them is registered for its type.
+ * This function must NOT be called from the rfc5444 writer callbacks.
+ *
+ * @param writer pointer to writer context
+ * @param msg pointer to binary message
+ * @param len number of bytes of message
+ * @param useIf pointer to interface selector
+ * @param param last parameter of interface selector
+ * @return RFC5444_OKAY if the message was put into the packet buffers,
+ *   RFC5444_... otherwise
+ */
+enum rfc5444_result
+rfc5444_writer_add_binary_msg(struct rfc5444_writer *writer, const uint8_t *msg, size_t len,
+  rfc5444_writer_targetselector useIf, void *param)
+{
+  struct rfc5444_writer_postprocessor *processor;
+  struct rfc5444_writer_target *target;
+  uint8_t *ptr;
+#if WRITER_STATE_MACHINE == true
+  assert(writer->_state == RFC5444_WRITER_NONE);
+#endif
+
+  if (len < 4 || len > writer->msg_size) {
+    return RFC5444_TOO_LARGE;
+  }
+
+  avl_for_each_element(&writer->_processors, processor, _node) {
+    if (processor->is_matching_signature(processor, msg[0])) {
+      return RFC5444_FW_BAD_TRANSFORM;
+    }
+  }
+
+  /* 1.) make sure the message fits into all selected targets */
+  oonf_list_for_each_element(&writer->_targets, target, _target_node) {
+    if (!useIf(writer, target, param)) {
+      continue;
+    }
+
+    if (!target->_is_flushed && target->_pkt.header + target->_pkt.added + target->_pkt.set + target->_bin_msgs_size +
+                                    len >
+                                  target->_pkt.max) {
+      /* flush the old packet */
+      rfc5444_writer_flush(writer, target, false);
+    }
+
+    if (target->_is_flushed) {
+      /* begin a new packet */
+      _rfc5444_writer_begin_packet(writer, target);
+    }
+
+    if (target->_pkt.header + target->_pkt.added + target->_pkt.set + target->_bin_msgs_size + len > target->_pkt.max) {
+      return RFC5444_MTU_TOO_SMALL;
+    }
+  }
+
+  /* 2.) copy message into the packet buffers */
+  oonf_list_for_each_element(&writer->_targets, target, _target_node) {
+    if (!useIf(writer, target, param)) {
+      continue;
+    }
+
+    ptr =
+      &target->_pkt.buffer[target->_pkt.header + target->_pkt.added + target->_pkt.allocated + target->_bin_msgs_size];
+    memcpy(ptr, msg, len);
+    target->_bin_msgs_size += len;
+
+    if (writer->message_generation_notifier) {
+      writer->message_generation_notifier(target);
+    }
+  }
+  return RFC5444_OKAY;
+}
+
 /**
  * Adds a tlv to a message.
  * This function must not be called outside the message add_tlv callback.
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Static memory pools for the RFC5444 reader and writer
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "rfc5444_pool.h"
+
+static struct rfc5444_reader_tlvblock_entry *_alloc_tlvblock_entry(struct rfc5444_reader *reader);
+static struct rfc5444_reader_addrblock_entry *_alloc_addrblock_entry(struct rfc5444_reader *reader);
+static void _free_tlvblock_entry(struct rfc5444_reader *reader, struct rfc5444_reader_tlvblock_entry *entry);
+static void _free_addrblock_entry(struct rfc5444_reader *reader, struct rfc5444_reader_addrblock_entry *entry);
+static struct rfc5444_writer_address *_alloc_address_entry(void);
+static struct rfc5444_writer_addrtlv *_alloc_addrtlv_entry(void);
+static void _free_address_entry(struct rfc5444_writer_address *addr);
+static void _free_addrtlv_entry(struct rfc5444_writer_addrtlv *addrtlv);
+static void _free_all_address_entries(struct rfc5444_writer *writer);
+static struct rfc5444_writer_message *_alloc_message_entry(void);
+static void _free_message_entry(struct rfc5444_writer_message *msg);
+
+static struct rfc5444_writer_address _waddr_storage[CONFIG_RFC5444_WRITER_POOL_ADDRS];
+static struct rfc5444_writer_addrtlv _waddrtlv_storage[CONFIG_RFC5444_WRITER_POOL_ADDRTLVS];
+static struct rfc5444_writer_message _wmsg_storage[CONFIG_RFC5444_WRITER_POOL_MSGS];
+
+static struct rfc5444_pool _waddr_pool;
+static struct rfc5444_pool _waddrtlv_pool;
+static struct rfc5444_pool _wmsg_pool;
+
+/**
+ * Initialize a pool
+ * @param pool pointer to pool
+ * @param storage memory for the blocks, suitably aligned for them
+ * @param block_size size of a block, at least the size of a pointer
+ * @param count number of blocks in storage
+ */
+void
+rfc5444_pool_init(struct rfc5444_pool *pool, void *storage, size_t block_size, uint16_t count) {
+  assert(block_size >= sizeof(void *));
+
+  memset(pool, 0, sizeof(*pool));
+  mutex_init(&pool->_lock);
+  pool->stats.size = count;
+  pool->_storage = storage;
+  pool->_block_size = block_size;
+
+  rfc5444_pool_reset(pool);
+}
+
+/**
+ * Allocate a block from a pool
+ * @param pool pointer to pool
+ * @return pointer to cleared block, NULL if pool is empty
+ */
+void *
+rfc5444_pool_alloc(struct rfc5444_pool *pool) {
+  void *block;
+
+  mutex_lock(&pool->_lock);
+  block = pool->_free;
+  if (block == NULL) {
+    pool->stats.exhausted++;
+    mutex_unlock(&pool->_lock);
+    return NULL;
+  }
+
+  pool->_free = *(void **)block;
+
+  pool->stats.used++;
+  if (pool->stats.used > pool->stats.max_used) {
+    pool->stats.max_used = pool->stats.used;
+  }
+  mutex_unlock(&pool->_lock);
+
+  memset(block, 0, pool->_block_size);
+  return block;
+}
+
+/**
+ * Return a block to its pool
+ * @param pool pointer to pool
+ * @param block pointer to block allocated from pool
+ */
+void
+rfc5444_pool_free(struct rfc5444_pool *pool, void *block) {
+  assert((uint8_t *)block >= pool->_storage &&
+         (uint8_t *)block < pool->_storage + pool->stats.size * pool->_block_size);
+
+  mutex_lock(&pool->_lock);
+  assert(pool->stats.used > 0);
+
+  *(void **)block = pool->_free;
+  pool->_free = block;
+  pool->stats.used--;
+  mutex_unlock(&pool->_lock);
+}
+
+/**
+ * Return all blocks to a pool at once, without touching them one by one.
+ * Every block allocated from the pool becomes invalid.
+ * @param pool pointer to pool
+ */
+void
+rfc5444_pool_reset(struct rfc5444_pool *pool) {
+  uint16_t i;
+
+  mutex_lock(&pool->_lock);
+  pool->_free = NULL;
+  pool->stats.used = 0;
+
+  /* chain all blocks into the free list, first block first */
+  for (i = pool->stats.size; i > 0; i--) {
+    void *block = &pool->_storage[(i - 1) * pool->_block_size];
+
+    *(void **)block = pool->_free;
+    pool->_free = block;
+  }
+  mutex_unlock(&pool->_lock);
+}
+
+/**
+ * Make a reader take its tlvblock and addrblock entries from pools instead
+ * of the heap. Packets that need more entries than the pools have left are
+ * dropped with RFC5444_OUT_OF_MEMORY. Packets can be handled concurrently,
+ * they share the entries of the pools.
+ * @param reader pointer to reader context
+ * @param pool pointer to the pools of the reader, must outlive it
+ */
+void
+rfc5444_reader_pool_attach(struct rfc5444_reader *reader, struct rfc5444_reader_pool *pool) {
+  rfc5444_pool_init(&pool->tlvs, pool->_tlv_storage, sizeof(pool->_tlv_storage[0]), ARRAYSIZE(pool->_tlv_storage));
+  rfc5444_pool_init(&pool->addrs, pool->_addr_storage, sizeof(pool->_addr_storage[0]), ARRAYSIZE(pool->_addr_storage));
+
+  reader->allocator = pool;
+
+  reader->malloc_tlvblock_entry = _alloc_tlvblock_entry;
+  reader->malloc_addrblock_entry = _alloc_addrblock_entry;
+  reader->free_tlvblock_entry = _free_tlvblock_entry;
+  reader->free_addrblock_entry = _free_addrblock_entry;
+}
+
+/**
+ * Get the usage statistics of the pools of a reader
+ * @param pool pointer to the pools of the reader
+ * @param stats pointer to statistics
+ */
+void
+rfc5444_reader_pool_get_stats(struct rfc5444_reader_pool *pool, struct rfc5444_reader_pool_stats *stats) {
+  stats->tlvs = pool->tlvs.stats;
+  stats->addrs = pool->addrs.stats;
+}
+
+/**
+ * Make a writer take its addresses, address tlvs and message objects from
+ * the static writer pools instead of the heap. Addresses and address tlvs
+ * are released in one step once a message has been generated, messages
+ * with more of them than the pools hold fail with RFC5444_OUT_OF_MEMORY.
+ * Must be called before rfc5444_writer_init(), the pools are shared so
+ * only a single writer may use them.
+ * @param writer pointer to writer context
+ */
+void
+rfc5444_writer_pool_attach(struct rfc5444_writer *writer) {
+  rfc5444_pool_init(&_waddr_pool, _waddr_storage, sizeof(_waddr_storage[0]), ARRAYSIZE(_waddr_storage));
+  rfc5444_pool_init(&_waddrtlv_pool, _waddrtlv_storage, sizeof(_waddrtlv_storage[0]), ARRAYSIZE(_waddrtlv_storage));
+  rfc5444_pool_init(&_wmsg_pool, _wmsg_storage, sizeof(_wmsg_storage[0]), ARRAYSIZE(_wmsg_storage));
+
+  writer->malloc_address_entry = _alloc_address_entry;
+  writer->malloc_addrtlv_entry = _alloc_addrtlv_entry;
+  writer->free_address_entry = _free_address_entry;
+  writer->free_addrtlv_entry = _free_addrtlv_entry;
+  writer->free_all_address_entries = _free_all_address_entries;
+  writer->malloc_message_entry = _alloc_message_entry;
+  writer->free_message_entry = _free_message_entry;
+}
+
+/**
+ * Get the usage statistics of the writer pools
+ * @param stats pointer to statistics
+ */
+void
+rfc5444_writer_pool_get_stats(struct rfc5444_writer_pool_stats *stats) {
+  stats->addrs = _waddr_pool.stats;
+  stats->addrtlvs = _waddrtlv_pool.stats;
+  stats->msgs = _wmsg_pool.stats;
+}
+
+static struct rfc5444_reader_tlvblock_entry *
+_alloc_tlvblock_entry(struct rfc5444_reader *reader) {
+  struct rfc5444_reader_pool *pool = reader->allocator;
+  return rfc5444_pool_alloc(&pool->tlvs);
+}
+
+static struct rfc5444_reader_addrblock_entry *
+_alloc_addrblock_entry(struct rfc5444_reader *reader) {
+  struct rfc5444_reader_pool *pool = reader->allocator;
+  return rfc5444_pool_alloc(&pool->addrs);
+}
+
+static void
+_free_tlvblock_entry(struct rfc5444_reader *reader, struct rfc5444_reader_tlvblock_entry *entry) {
+  struct rfc5444_reader_pool *pool = reader->allocator;
+  rfc5444_pool_free(&pool->tlvs, entry);
+}
+
+static void
+_free_addrblock_entry(struct rfc5444_reader *reader, struct rfc5444_reader_addrblock_entry *entry) {
+  struct rfc5444_reader_pool *pool = reader->allocator;
+  rfc5444_pool_free(&pool->addrs, entry);
+}
+
+static struct rfc5444_writer_address *
+_alloc_address_entry(void) {
+  return rfc5444_pool_alloc(&_waddr_pool);
+}
+
+static struct rfc5444_writer_addrtlv *
+_alloc_addrtlv_entry(void) {
+  return rfc5444_pool_alloc(&_waddrtlv_pool);
+}
+
+static void
+_free_address_entry(struct rfc5444_writer_address *addr) {
+  rfc5444_pool_free(&_waddr_pool, addr);
+}
+
+static void
+_free_addrtlv_entry(struct rfc5444_writer_addrtlv *addrtlv) {
+  rfc5444_pool_free(&_waddrtlv_pool, addrtlv);
+}
+
+static void
+_free_all_address_entries(struct rfc5444_writer *writer __attribute__((unused))) {
+  rfc5444_pool_reset(&_waddrtlv_pool);
+  rfc5444_pool_reset(&_waddr_pool);
+}
+
+static struct rfc5444_writer_message *
+_alloc_message_entry(void) {
+  return rfc5444_pool_alloc(&_wmsg_pool);
+}
+
+static void
+_free_message_entry(struct rfc5444_writer_message *msg) {
+  rfc5444_pool_free(&_wmsg_pool, msg);
+}
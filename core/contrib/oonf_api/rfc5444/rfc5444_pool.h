@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Static memory pools for the RFC5444 reader and writer
+ *
+ * Fixed size blocks are kept on a free list inside statically allocated
+ * storage, allocation and release are O(1) and never touch the heap.
+ * The free list is locked, so a pool can be shared by threads.
+ */
+
+#ifndef RFC5444_POOL_H_
+#define RFC5444_POOL_H_
+
+#include "mutex.h"
+
+#include "common/common_types.h"
+#include "rfc5444_reader.h"
+#include "rfc5444_writer.h"
+
+/**
+ * number of tlvblock entries of the reader pool
+ */
+#ifndef CONFIG_RFC5444_READER_POOL_TLVS
+#define CONFIG_RFC5444_READER_POOL_TLVS (16)
+#endif
+
+/**
+ * number of addrblock entries of the reader pool
+ */
+#ifndef CONFIG_RFC5444_READER_POOL_ADDRS
+#define CONFIG_RFC5444_READER_POOL_ADDRS (4)
+#endif
+
+/**
+ * number of address entries of the writer pool
+ */
+#ifndef CONFIG_RFC5444_WRITER_POOL_ADDRS
+#define CONFIG_RFC5444_WRITER_POOL_ADDRS (4)
+#endif
+
+/**
+ * number of address tlv entries of the writer pool
+ */
+#ifndef CONFIG_RFC5444_WRITER_POOL_ADDRTLVS
+#define CONFIG_RFC5444_WRITER_POOL_ADDRTLVS (8)
+#endif
+
+/**
+ * number of message objects of the writer pool
+ */
+#ifndef CONFIG_RFC5444_WRITER_POOL_MSGS
+#define CONFIG_RFC5444_WRITER_POOL_MSGS (3)
+#endif
+
+/**
+ * usage statistics of a pool
+ */
+struct rfc5444_pool_stats {
+  /*! number of blocks of the pool */
+  uint16_t size;
+
+  /*! number of blocks currently allocated */
+  uint16_t used;
+
+  /*! highest number of blocks allocated at the same time */
+  uint16_t max_used;
+
+  /*! number of allocations that failed because the pool was empty */
+  uint32_t exhausted;
+};
+
+/**
+ * pool of fixed size memory blocks
+ */
+struct rfc5444_pool {
+  /*! usage statistics */
+  struct rfc5444_pool_stats stats;
+
+  /*! storage of the blocks */
+  uint8_t *_storage;
+
+  /*! size of a block */
+  size_t _block_size;
+
+  /*! first free block, each free block points to the next one */
+  void *_free;
+
+  /*! lock of the free list and the statistics */
+  mutex_t _lock;
+};
+
+/**
+ * tlvblock and addrblock entries of a reader
+ */
+struct rfc5444_reader_pool {
+  /*! pool of tlvblock entries */
+  struct rfc5444_pool tlvs;
+
+  /*! pool of addrblock entries */
+  struct rfc5444_pool addrs;
+
+  /*! storage of the tlvblock entries */
+  struct rfc5444_reader_tlvblock_entry _tlv_storage[CONFIG_RFC5444_READER_POOL_TLVS];
+
+  /*! storage of the addrblock entries */
+  struct rfc5444_reader_addrblock_entry _addr_storage[CONFIG_RFC5444_READER_POOL_ADDRS];
+};
+
+/**
+ * statistics of the reader pools
+ */
+struct rfc5444_reader_pool_stats {
+  /*! tlvblock entries */
+  struct rfc5444_pool_stats tlvs;
+
+  /*! addrblock entries */
+  struct rfc5444_pool_stats addrs;
+};
+
+/**
+ * statistics of the writer pools
+ */
+struct rfc5444_writer_pool_stats {
+  /*! address entries */
+  struct rfc5444_pool_stats addrs;
+
+  /*! address tlv entries */
+  struct rfc5444_pool_stats addrtlvs;
+
+  /*! message objects */
+  struct rfc5444_pool_stats msgs;
+};
+
+EXPORT void rfc5444_pool_init(struct rfc5444_pool *pool, void *storage, size_t block_size, uint16_t count);
+EXPORT void *rfc5444_pool_alloc(struct rfc5444_pool *pool);
+EXPORT void rfc5444_pool_free(struct rfc5444_pool *pool, void *block);
+EXPORT void rfc5444_pool_reset(struct rfc5444_pool *pool);
+
+EXPORT void rfc5444_reader_pool_attach(struct rfc5444_reader *reader, struct rfc5444_reader_pool *pool);
+EXPORT void rfc5444_reader_pool_get_stats(struct rfc5444_reader_pool *pool, struct rfc5444_reader_pool_stats *stats);
+
+EXPORT void rfc5444_writer_pool_attach(struct rfc5444_writer *writer);
+EXPORT void rfc5444_writer_pool_get_stats(struct rfc5444_writer_pool_stats *stats);
+
+#endif /* RFC5444_POOL_H_ */
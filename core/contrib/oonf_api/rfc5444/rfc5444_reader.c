@@ -71,13 +71,17 @@ static int _compare_tlvtypes(
   struct rfc5444_reader_tlvblock_entry *tlv, struct rfc5444_reader_tlvblock_consumer_entry *entry);
 static uint8_t _rfc5444_get_u8(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *result);
 static uint16_t _rfc5444_get_u16(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *result);
-static void _free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries);
+static void _init_tlvblock(struct rfc5444_reader_tlvblock *block);
+static void _add_tlvblock_entry(struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv);
+static struct rfc5444_reader_tlvblock_entry *_next_tlvblock_entry(
+  struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv, uint16_t *pos);
+static void _free_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *block);
 static enum rfc5444_result _parse_tlv(
   struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr, const uint8_t *eob, uint8_t addr_count);
-static enum rfc5444_result _parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock, const uint8_t **ptr,
-  const uint8_t *eob, uint8_t addr_count);
+static enum rfc5444_result _parse_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *tlvblock,
+  const uint8_t **ptr, const uint8_t *eob, uint8_t addr_count);
 static enum rfc5444_result _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer,
-  struct rfc5444_reader_tlvblock_context *context, struct avl_tree *entries, uint8_t idx);
+  struct rfc5444_reader_tlvblock_context *context, struct rfc5444_reader_tlvblock *entries, uint8_t idx);
 static enum rfc5444_result _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry,
   struct rfc5444_reader_tlvblock_context *tlv_context, const uint8_t **ptr, const uint8_t *eob);
 static enum rfc5444_result _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_context *tlv_context,
@@ -85,10 +89,13 @@ static enum rfc5444_result _handle_message(struct rfc5444_reader *parser, struct
 static struct rfc5444_reader_tlvblock_consumer *_add_consumer(struct rfc5444_reader_tlvblock_consumer *,
   struct avl_tree *consumer_tree, struct rfc5444_reader_tlvblock_consumer_entry *entries, int entrycount);
 static void _free_consumer(struct avl_tree *consumer_tree, struct rfc5444_reader_tlvblock_consumer *consumer);
-static struct rfc5444_reader_addrblock_entry *_malloc_addrblock_entry(void);
-static struct rfc5444_reader_tlvblock_entry *_malloc_tlvblock_entry(void);
-static void _free_addrblock_entry(struct rfc5444_reader_addrblock_entry *entry);
-static void _free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry);
+static void _build_msg_dispatch(struct rfc5444_reader *parser);
+static struct rfc5444_reader_tlvblock_consumer *_next_msg_consumer(struct rfc5444_reader *parser, uint8_t msg_type,
+  struct rfc5444_reader_tlvblock_consumer *consumer, uint16_t *pos);
+static struct rfc5444_reader_addrblock_entry *_malloc_addrblock_entry(struct rfc5444_reader *);
+static struct rfc5444_reader_tlvblock_entry *_malloc_tlvblock_entry(struct rfc5444_reader *);
+static void _free_addrblock_entry(struct rfc5444_reader *, struct rfc5444_reader_addrblock_entry *entry);
+static void _free_tlvblock_entry(struct rfc5444_reader *, struct rfc5444_reader_tlvblock_entry *entry);
 
 static uint8_t rfc5444_get_pktversion(uint8_t v);
 
@@ -100,6 +107,8 @@ void
 rfc5444_reader_init(struct rfc5444_reader *context) {
   avl_init(&context->packet_consumer, _consumer_avl_comp, true);
   avl_init(&context->message_consumer, _consumer_avl_comp, true);
+  context->_msg_dispatch_list = NULL;
+  _build_msg_dispatch(context);
 
   if (context->malloc_addrblock_entry == NULL)
     context->malloc_addrblock_entry = _malloc_addrblock_entry;
@@ -121,6 +130,9 @@ void
 rfc5444_reader_cleanup(struct rfc5444_reader *context) {
   memset(&context->packet_consumer, 0, sizeof(context->packet_consumer));
   memset(&context->message_consumer, 0, sizeof(context->message_consumer));
+
+  free(context->_msg_dispatch_list);
+  context->_msg_dispatch_list = NULL;
 }
 
 /**
@@ -132,9 +144,27 @@ rfc5444_reader_cleanup(struct rfc5444_reader *context) {
  */
 enum rfc5444_result
 rfc5444_reader_handle_packet(struct rfc5444_reader *parser, const uint8_t *buffer, size_t length)
+{
+  return rfc5444_reader_handle_packet_ctx(parser, buffer, length, NULL);
+}
+
+/**
+ * parse a complete rfc5444 packet with a user supplied context.
+ * The context is available to all callbacks as the user_ctx field of
+ * the tlvblock context, which allows parsing several packets with the
+ * same reader without sharing any state between them.
+ * @param parser pointer to parser context
+ * @param buffer pointer to begin of rfc5444 packet
+ * @param length number of bytes in buffer
+ * @param user_ctx user context of this packet
+ * @return RFC5444_OKAY (0) if successful, RFC5444_... otherwise
+ */
+enum rfc5444_result
+rfc5444_reader_handle_packet_ctx(
+  struct rfc5444_reader *parser, const uint8_t *buffer, size_t length, void *user_ctx)
 {
   struct rfc5444_reader_tlvblock_context context;
-  struct avl_tree entries;
+  struct rfc5444_reader_tlvblock entries;
   struct rfc5444_reader_tlvblock_consumer *consumer, *last_started;
   const uint8_t *ptr, *eob;
   bool has_tlv;
@@ -153,6 +183,7 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser, const uint8_t *buffe
   memset(&context, 0, sizeof(context));
   context.type = RFC5444_CONTEXT_PACKET;
   context.reader = parser;
+  context.user_ctx = user_ctx;
 
   /* read header of packet */
   first_byte = _rfc5444_get_u8(&ptr, eob, &result);
@@ -181,8 +212,8 @@ rfc5444_reader_handle_packet(struct rfc5444_reader *parser, const uint8_t *buffe
     return result;
   }
 
-  /* initialize avl_tree */
-  avl_init(&entries, avl_comp_uint32, true);
+  /* initialize tlvblock */
+  _init_tlvblock(&entries);
   last_started = NULL;
 
   /* check for packet tlv */
@@ -287,6 +318,7 @@ void
 rfc5444_reader_add_message_consumer(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_consumer *consumer,
   struct rfc5444_reader_tlvblock_consumer_entry *entries, size_t entrycount) {
   _add_consumer(consumer, &parser->message_consumer, entries, entrycount);
+  _build_msg_dispatch(parser);
 }
 
 /**
@@ -310,6 +342,7 @@ void
 rfc5444_reader_remove_message_consumer(
   struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_consumer *consumer) {
   _free_consumer(&parser->message_consumer, consumer);
+  _build_msg_dispatch(parser);
 }
 
 /**
@@ -420,16 +453,100 @@ _rfc5444_get_u16(const uint8_t **ptr, const uint8_t *end, enum rfc5444_result *e
 }
 
 /**
- * free a list of linked tlv_block entries
- * @param entries avl_tree of tlv_block entries
+ * initialize an empty TLV block
+ * @param block pointer to TLV block
+ */
+static void
+_init_tlvblock(struct rfc5444_reader_tlvblock *block) {
+  block->count = 0;
+  block->_use_tree = false;
+}
+
+/**
+ * add a tlv_block entry to a TLV block, keeping it sorted. Entries of
+ * the same type are kept in the order they were added while the block
+ * fits into its inline array.
+ * @param block pointer to TLV block
+ * @param tlv pointer to tlv_block entry
+ */
+static void
+_add_tlvblock_entry(struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv) {
+  uint16_t i;
+
+  if (!block->_use_tree && block->count == ARRAYSIZE(block->_inline)) {
+    /* block outgrew the inline array, move it into the tree */
+    avl_init(&block->_tree, avl_comp_uint16, true);
+    for (i = 0; i < block->count; i++) {
+      block->_inline[i]->node.key = &block->_inline[i]->_order;
+      avl_insert(&block->_tree, &block->_inline[i]->node);
+    }
+    block->_use_tree = true;
+  }
+
+  if (block->_use_tree) {
+    tlv->node.key = &tlv->_order;
+    avl_insert(&block->_tree, &tlv->node);
+  }
+  else {
+    /* insertion sort, behind all entries of the same type */
+    for (i = block->count; i > 0 && block->_inline[i - 1]->_order > tlv->_order; i--) {
+      block->_inline[i] = block->_inline[i - 1];
+    }
+    block->_inline[i] = tlv;
+  }
+  block->count++;
+}
+
+/**
+ * iterate over the tlv_block entries of a TLV block in sorted order
+ * @param block pointer to TLV block
+ * @param tlv pointer to current tlv_block entry, NULL to get the first one
+ * @param pos pointer to position of the current entry, will be
+ *   set to the position of the returned one
+ * @return next tlv_block entry, NULL if there is none
+ */
+static struct rfc5444_reader_tlvblock_entry *
+_next_tlvblock_entry(
+  struct rfc5444_reader_tlvblock *block, struct rfc5444_reader_tlvblock_entry *tlv, uint16_t *pos) {
+  if (tlv == NULL) {
+    *pos = 0;
+  }
+  else {
+    (*pos)++;
+  }
+
+  if (*pos >= block->count) {
+    return NULL;
+  }
+  if (!block->_use_tree) {
+    return block->_inline[*pos];
+  }
+  if (tlv == NULL) {
+    return avl_first_element(&block->_tree, tlv, node);
+  }
+  return avl_next_element(tlv, node);
+}
+
+/**
+ * free all tlv_block entries of a TLV block
+ * @param block pointer to TLV block
  */
 static void
-_free_tlvblock(struct rfc5444_reader *parser, struct avl_tree *entries) {
+_free_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *block) {
   struct rfc5444_reader_tlvblock_entry *tlv, *ptr;
+  uint16_t i;
 
-  avl_remove_all_elements(entries, tlv, node, ptr) {
-    parser->free_tlvblock_entry(tlv);
+  if (block->_use_tree) {
+    avl_remove_all_elements(&block->_tree, tlv, node, ptr) {
+      parser->free_tlvblock_entry(parser, tlv);
+    }
   }
+  else {
+    for (i = 0; i < block->count; i++) {
+      parser->free_tlvblock_entry(parser, block->_inline[i]);
+    }
+  }
+  _init_tlvblock(block);
 }
 
 /**
@@ -483,7 +600,8 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr, con
   }
 
   /* consistency check for index fields */
-  if (addr_count > 0 && (entry->index1 >= addr_count || entry->index2 >= addr_count)) {
+  if (addr_count > 0 && (entry->index1 >= addr_count || entry->index2 >= addr_count
+      || entry->index1 > entry->index2)) {
     *ptr = eob;
     return RFC5444_BAD_TLV_INDEX;
   }
@@ -528,7 +646,8 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr, con
 
   /* handle multivalue TLVs */
   count = entry->index2 - entry->index1 + 1;
-  if (count == 1) {
+  if (count == 1 || addr_count == 0) {
+    /* message and packet tlvs have a single value */
     entry->_multivalue_tlv = false;
   }
   if (!entry->_multivalue_tlv) {
@@ -547,7 +666,7 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr, con
 
 /**
  * parse a TLV block into a list of linked tlvblock_entries.
- * @param tlvblock pointer to avl_tree to store generates tlvblock entries
+ * @param tlvblock pointer to TLV block to store generates tlvblock entries
  * @param ptr pointer to pointer to begin of datastream, will be
  *   incremented to the first byte after the block if no error happened.
  *   Will be set to eob if an error happened.
@@ -556,8 +675,8 @@ _parse_tlv(struct rfc5444_reader_tlvblock_entry *entry, const uint8_t **ptr, con
  *   packet tlv * @return -1 if an error happened, 0 otherwise
  */
 static enum rfc5444_result
-_parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock, const uint8_t **ptr, const uint8_t *eob,
-  uint8_t addr_count) {
+_parse_tlvblock(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock *tlvblock, const uint8_t **ptr,
+  const uint8_t *eob, uint8_t addr_count) {
   enum rfc5444_result result = RFC5444_OKAY;
   struct rfc5444_reader_tlvblock_entry *tlv1 = NULL;
   struct rfc5444_reader_tlvblock_entry entry;
@@ -586,7 +705,7 @@ _parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock, const
     }
 
     /* get memory to store TLV block entry */
-    tlv1 = parser->malloc_tlvblock_entry();
+    tlv1 = parser->malloc_tlvblock_entry(parser);
     if (tlv1 == NULL) {
       /* not enough memory left ! */
       result = RFC5444_OUT_OF_MEMORY;
@@ -597,8 +716,7 @@ _parse_tlvblock(struct rfc5444_reader *parser, struct avl_tree *tlvblock, const
     memcpy(tlv1, &entry, sizeof(entry));
 
     /* put into sorted list */
-    tlv1->node.key = &tlv1->_order;
-    avl_insert(tlvblock, &tlv1->node);
+    _add_tlvblock_entry(tlvblock, tlv1);
   }
 cleanup_parse_tlvblock:
   if (result != RFC5444_OKAY) {
@@ -612,7 +730,7 @@ cleanup_parse_tlvblock:
  * Call callbacks for parsed TLV blocks
  * @param consumer pointer to first consumer for this message type
  * @param context pointer to context for tlv block
- * @param entries pointer avl_tree of tlv block entries
+ * @param entries pointer to TLV block
  * @param idx of current address inside the addressblock, 0 for message tlv block
  * @return RFC5444_TLV_DROP_ADDRESS if the current address should
  *   be dropped for later consumers, RFC5444_TLV_DROP_CONTEXT if
@@ -621,21 +739,17 @@ cleanup_parse_tlvblock:
  */
 static enum rfc5444_result
 _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc5444_reader_tlvblock_context *context,
-  struct avl_tree *entries, uint8_t idx) {
+  struct rfc5444_reader_tlvblock *entries, uint8_t idx) {
   struct rfc5444_reader_tlvblock_entry *tlv = NULL, *nexttlv = NULL;
   struct rfc5444_reader_tlvblock_consumer_entry *cons_entry;
   bool constraints_failed;
+  uint16_t tlv_pos;
   enum rfc5444_result result = RFC5444_OKAY;
 
   constraints_failed = false;
 
   /* initialize tlv pointers, there must be TLVs */
-  if (avl_is_empty(entries)) {
-    tlv = NULL;
-  }
-  else {
-    tlv = avl_first_element(entries, tlv, node);
-  }
+  tlv = _next_tlvblock_entry(entries, NULL, &tlv_pos);
 
   /* initialize consumer pointer */
   if (oonf_list_is_empty(&consumer->_consumer_list)) {
@@ -732,12 +846,7 @@ _schedule_tlvblock(struct rfc5444_reader_tlvblock_consumer *consumer, struct rfc
     }
     if (tlv != NULL && _compare_tlvtypes(tlv, cons_entry) <= 0) {
       /* advance tlv pointer */
-      if (avl_is_last(entries, &tlv->node)) {
-        tlv = NULL;
-      }
-      else {
-        tlv = avl_next_element(tlv, node);
-      }
+      tlv = _next_tlvblock_entry(entries, tlv, &tlv_pos);
     }
     if (_compare_tlvtypes(tlv, cons_entry) > 0) {
       constraints_failed |= cons_entry->mandatory && !match;
@@ -849,11 +958,17 @@ _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry, struct rfc54
   /* check for tail flags */
   masked = flags & (RFC5444_ADDR_FLAG_FULLTAIL | RFC5444_ADDR_FLAG_ZEROTAIL);
   if (masked == RFC5444_ADDR_FLAG_ZEROTAIL) {
-    addr_entry->mid_len -= _rfc5444_get_u8(ptr, eob, &result);
+    tail_len = _rfc5444_get_u8(ptr, eob, &result);
+    if (tail_len > addr_entry->mid_len) {
+      /* head and tail overlap */
+      return RFC5444_BAD_ADDR_TAIL_LENGTH;
+    }
+    addr_entry->mid_len -= tail_len;
   }
   else if (masked == RFC5444_ADDR_FLAG_FULLTAIL) {
     tail_len = _rfc5444_get_u8(ptr, eob, &result);
-    if (tail_len < 1 || tail_len >= RFC5444_MAX_ADDRLEN || tail_len >= tlv_context->addr_len) {
+    if (tail_len < 1 || tail_len >= RFC5444_MAX_ADDRLEN || tail_len >= tlv_context->addr_len
+        || tail_len > addr_entry->mid_len) {
       return RFC5444_BAD_ADDR_TAIL_LENGTH;
     }
     if (*ptr + tail_len > eob) {
@@ -883,8 +998,7 @@ _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry, struct rfc54
     addr_entry->prefixlen = tlv_context->addr_len * 8;
   }
   else if (masked == RFC5444_ADDR_FLAG_SINGLEPLEN) {
-    addr_entry->prefixlen = **ptr;
-    *ptr += 1;
+    addr_entry->prefixlen = _rfc5444_get_u8(ptr, eob, &result);
   }
   else if (masked == RFC5444_ADDR_FLAG_MULTIPLEN) {
     addr_entry->prefixes = *ptr;
@@ -908,13 +1022,13 @@ _parse_addrblock(struct rfc5444_reader_addrblock_entry *addr_entry, struct rfc54
  * Call start and tlvblock callbacks for message tlv consumer
  * @param consumer pointer to tlvblock consumer object
  * @param tlv_context current tlv context
- * @param tlv_entries pointer to tlventry avltree
+ * @param tlv_entries pointer to message TLV block
  * @return RFC5444_OKAY if no error happend, RFC5444_DROP_ if a
  *   context (message or packet) should be dropped
  */
 static enum rfc5444_result
 schedule_msgtlv_consumer(struct rfc5444_reader_tlvblock_consumer *consumer,
-  struct rfc5444_reader_tlvblock_context *tlv_context, struct avl_tree *tlv_entries) {
+  struct rfc5444_reader_tlvblock_context *tlv_context, struct rfc5444_reader_tlvblock *tlv_entries) {
   enum rfc5444_result result = RFC5444_OKAY;
   tlv_context->type = RFC5444_CONTEXT_MESSAGE;
 
@@ -1073,20 +1187,20 @@ schedule_end_message_cbs(struct rfc5444_reader_tlvblock_context *tlv_context,
 static enum rfc5444_result
 _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_context *tlv_context, const uint8_t **ptr,
   const uint8_t *eob) {
-  struct avl_tree tlv_entries;
+  struct rfc5444_reader_tlvblock tlv_entries;
   struct rfc5444_reader_tlvblock_consumer *consumer, *same_order[2];
   struct oonf_list_entity addr_head;
   struct rfc5444_reader_addrblock_entry *addr, *safe;
   const uint8_t *start, *end = NULL;
   uint8_t flags;
-  uint16_t size;
+  uint16_t size, consumer_pos;
 
   enum rfc5444_result result;
 
   /* initialize variables */
   result = RFC5444_OKAY;
   same_order[0] = same_order[1] = NULL;
-  avl_init(&tlv_entries, avl_comp_uint16, true);
+  _init_tlvblock(&tlv_entries);
   oonf_list_init_head(&addr_head);
   tlv_context->_do_not_forward = false;
 
@@ -1131,9 +1245,10 @@ _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_co
     tlv_context->seqno = _rfc5444_get_u16(ptr, eob, &result);
   }
 
-  /* check for error during header parsing or bad length */
+  /* check for error during header parsing or bad length,
+   * a message must at least contain its own header */
   end = start + size;
-  if (end > eob) {
+  if (end > eob || end < *ptr) {
     *ptr = eob;
     result = RFC5444_END_OF_BUFFER;
   }
@@ -1141,6 +1256,12 @@ _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_co
     goto cleanup_parse_message;
   }
 
+  /* nobody is interested in the content of this message type */
+  consumer = _next_msg_consumer(parser, tlv_context->msg_type, NULL, &consumer_pos);
+  if (consumer == NULL && parser->forward_message == NULL) {
+    goto cleanup_parse_message;
+  }
+
   /* parse message TLV block */
   result = _parse_tlvblock(parser, &tlv_entries, ptr, end, 0);
   if (result != RFC5444_OKAY) {
@@ -1151,25 +1272,25 @@ _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_co
   /* parse rest of message */
   while (*ptr < end) {
     /* get memory for storing the address block entry */
-    addr = parser->malloc_addrblock_entry();
+    addr = parser->malloc_addrblock_entry(parser);
     if (addr == NULL) {
       result = RFC5444_OUT_OF_MEMORY;
       goto cleanup_parse_message;
     }
 
-    /* initialize avl_tree */
-    avl_init(&addr->tlvblock, avl_comp_uint16, true);
+    /* initialize tlvblock */
+    _init_tlvblock(&addr->tlvblock);
 
     /* parse address block... */
     if ((result = _parse_addrblock(addr, tlv_context, ptr, end)) != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
+      parser->free_addrblock_entry(parser, addr);
       goto cleanup_parse_message;
     }
 
     /* ... and corresponding tlvblock */
     result = _parse_tlvblock(parser, &addr->tlvblock, ptr, end, addr->num_addr);
     if (result != RFC5444_OKAY) {
-      parser->free_addrblock_entry(addr);
+      parser->free_addrblock_entry(parser, addr);
       goto cleanup_parse_message;
     }
 
@@ -1183,13 +1304,8 @@ _handle_message(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_co
   tlv_context->msg_buffer = start;
   tlv_context->msg_size = size;
 
-  /* loop through list of message/address consumers */
-  avl_for_each_element(&parser->message_consumer, consumer, _node) {
-    if (!consumer->default_msg_consumer && consumer->msg_id != tlv_context->msg_type) {
-      /* wrong type of message, continue... */
-      continue;
-    }
-
+  /* loop through list of message/address consumers of this message type */
+  for (; consumer != NULL; consumer = _next_msg_consumer(parser, tlv_context->msg_type, consumer, &consumer_pos)) {
     /* remember range of consumers with same order to call end_message() callbacks */
     if (same_order[0] != NULL && consumer->order > same_order[1]->order) {
 #if DISALLOW_CONSUMER_CONTEXT_DROP == false
@@ -1262,7 +1378,7 @@ cleanup_parse_message:
   /* free address tlvblocks */
   oonf_list_for_each_element_safe(&addr_head, addr, oonf_list_node, safe) {
     _free_tlvblock(parser, &addr->tlvblock);
-    parser->free_addrblock_entry(addr);
+    parser->free_addrblock_entry(parser, addr);
   }
 
   /* free message tlvblock */
@@ -1343,37 +1459,43 @@ _free_consumer(struct avl_tree *consumer_tree, struct rfc5444_reader_tlvblock_co
 
 /**
  * Internal memory allocation function for addrblock
+ * @param parser pointer to parser context (unused)
  * @return pointer to cleared addrblock
  */
 static struct rfc5444_reader_addrblock_entry *
-_malloc_addrblock_entry(void) {
+_malloc_addrblock_entry(struct rfc5444_reader *parser __attribute__((unused))) {
   return calloc(1, sizeof(struct rfc5444_reader_addrblock_entry));
 }
 
 /**
  * Internal memory allocation function for rfc5444_reader_tlvblock_entry
+ * @param parser pointer to parser context (unused)
  * @return pointer to cleared rfc5444_reader_tlvblock_entry
  */
 static struct rfc5444_reader_tlvblock_entry *
-_malloc_tlvblock_entry(void) {
+_malloc_tlvblock_entry(struct rfc5444_reader *parser __attribute__((unused))) {
   return calloc(1, sizeof(struct rfc5444_reader_tlvblock_entry));
 }
 
 /**
  * Free an addressblock entry
+ * @param parser pointer to parser context (unused)
  * @param entry addressblock entry
  */
 static void
-_free_addrblock_entry(struct rfc5444_reader_addrblock_entry *entry) {
+_free_addrblock_entry(
+  struct rfc5444_reader *parser __attribute__((unused)), struct rfc5444_reader_addrblock_entry *entry) {
   free(entry);
 }
 
 /**
  * Free an tlvblock entry
+ * @param parser pointer to parser context (unused)
  * @param entry tlvblock entry
  */
 static void
-_free_tlvblock_entry(struct rfc5444_reader_tlvblock_entry *entry) {
+_free_tlvblock_entry(
+  struct rfc5444_reader *parser __attribute__((unused)), struct rfc5444_reader_tlvblock_entry *entry) {
   free(entry);
 }
 
@@ -1385,3 +1507,110 @@ static uint8_t
 rfc5444_get_pktversion(uint8_t v) {
   return v >> 4;
 }
+
+/**
+ * Rebuild the message type dispatch table of a parser. Message types
+ * without specific consumers share the list of default consumers.
+ * If no memory is available, consumers are looked up in the
+ * message_consumer tree instead.
+ * @param parser pointer to parser context
+ */
+static void
+_build_msg_dispatch(struct rfc5444_reader *parser) {
+  struct rfc5444_reader_tlvblock_consumer *consumer;
+  struct rfc5444_reader_tlvblock_consumer **list;
+  struct bitmap256 types;
+  size_t list_len, types_count, offset;
+  unsigned t;
+
+  free(parser->_msg_dispatch_list);
+  parser->_msg_dispatch_list = NULL;
+  memset(parser->_msg_dispatch, 0, sizeof(parser->_msg_dispatch));
+
+  /* collect message types with specific consumers */
+  memset(&types, 0, sizeof(types));
+  types_count = 0;
+  avl_for_each_element(&parser->message_consumer, consumer, _node) {
+    if (!consumer->default_msg_consumer && !bitmap256_get(&types, consumer->msg_id)) {
+      bitmap256_set(&types, consumer->msg_id);
+      types_count++;
+    }
+  }
+
+  /* one list for the default consumers and one per specific type */
+  list_len = parser->message_consumer.count + 1;
+  if ((types_count + 1) * list_len > UINT16_MAX) {
+    return;
+  }
+  list = calloc((types_count + 1) * list_len, sizeof(*list));
+  if (list == NULL) {
+    return;
+  }
+
+  offset = 0;
+  avl_for_each_element(&parser->message_consumer, consumer, _node) {
+    if (consumer->default_msg_consumer) {
+      list[offset++] = consumer;
+    }
+  }
+  offset = list_len;
+
+  for (t = 0; t < 256; t++) {
+    if (!bitmap256_get(&types, t)) {
+      continue;
+    }
+
+    parser->_msg_dispatch[t] = offset;
+    avl_for_each_element(&parser->message_consumer, consumer, _node) {
+      if (consumer->default_msg_consumer || consumer->msg_id == t) {
+        list[offset++] = consumer;
+      }
+    }
+    offset = parser->_msg_dispatch[t] + list_len;
+  }
+
+  parser->_msg_dispatch_list = list;
+}
+
+/**
+ * Iterate over the consumers of a message type in the order
+ * of the message_consumer tree.
+ * @param parser pointer to parser context
+ * @param msg_type message type
+ * @param consumer pointer to current consumer, NULL to get the first one
+ * @param pos pointer to iterator state
+ * @return next consumer, NULL if there is none
+ */
+static struct rfc5444_reader_tlvblock_consumer *
+_next_msg_consumer(struct rfc5444_reader *parser, uint8_t msg_type,
+  struct rfc5444_reader_tlvblock_consumer *consumer, uint16_t *pos) {
+  if (consumer == NULL) {
+    *pos = 0;
+  }
+
+  if (parser->_msg_dispatch_list != NULL) {
+    return parser->_msg_dispatch_list[parser->_msg_dispatch[msg_type] + (*pos)++];
+  }
+
+  /* no dispatch table, walk the tree */
+  if (consumer == NULL) {
+    if (avl_is_empty(&parser->message_consumer)) {
+      return NULL;
+    }
+    consumer = avl_first_element(&parser->message_consumer, consumer, _node);
+  }
+  else if (avl_is_last(&parser->message_consumer, &consumer->_node)) {
+    return NULL;
+  }
+  else {
+    consumer = avl_next_element(consumer, _node);
+  }
+
+  while (!consumer->default_msg_consumer && consumer->msg_id != msg_type) {
+    if (avl_is_last(&parser->message_consumer, &consumer->_node)) {
+      return NULL;
+    }
+    consumer = avl_next_element(consumer, _node);
+  }
+  return consumer;
+}
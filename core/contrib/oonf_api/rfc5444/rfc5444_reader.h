@@ -52,6 +52,14 @@
 #include "common/netaddr.h"
 #include "rfc5444_context.h"
 
+/**
+ * number of TLVs a TLV block keeps in its sorted inline array before
+ * switching to an avl tree
+ */
+#ifndef CONFIG_RFC5444_READER_TLVBLOCK_INLINE
+#define CONFIG_RFC5444_READER_TLVBLOCK_INLINE (4)
+#endif
+
 /**
  * type of context for a rfc5444_reader_tlvblock_context
  */
@@ -66,7 +74,7 @@ enum rfc5444_reader_tlvblock_context_type
  * This struct temporary holds the content of a decoded TLV.
  */
 struct rfc5444_reader_tlvblock_entry {
-  /*! tree of TLVs */
+  /*! tree of TLVs, only used for large TLV blocks */
   struct avl_node node;
 
   /*! tlv type */
@@ -115,6 +123,25 @@ struct rfc5444_reader_tlvblock_entry {
   struct bitmap256 int_drop_tlv;
 };
 
+/**
+ * Parsed TLVs of a TLV block, sorted by type and extended type.
+ * Small blocks are kept in an inline array ordered by insertion sort,
+ * larger ones are moved into an avl tree.
+ */
+struct rfc5444_reader_tlvblock {
+  /*! number of TLVs in the block */
+  uint16_t count;
+
+  /*! true if the TLVs have been moved into the tree */
+  bool _use_tree;
+
+  /*! TLVs of a small block, TLVs of the same type keep their packet order */
+  struct rfc5444_reader_tlvblock_entry *_inline[CONFIG_RFC5444_READER_TLVBLOCK_INLINE];
+
+  /*! tree of TLVs of a large block */
+  struct avl_tree _tree;
+};
+
 /**
  * common context for packet, message and address TLV block
  */
@@ -125,6 +152,9 @@ struct rfc5444_reader_tlvblock_context {
   /*! pointer to tlvblock consumer */
   struct rfc5444_reader_tlvblock_consumer *consumer;
 
+  /*! user supplied context of the packet being parsed, NULL if none */
+  void *user_ctx;
+
   /*! applicable for all TLV blocks */
   enum rfc5444_reader_tlvblock_context_type type;
 
@@ -216,7 +246,7 @@ struct rfc5444_reader_addrblock_entry {
   struct oonf_list_entity oonf_list_node;
 
   /*! corresponding tlv block */
-  struct avl_tree tlvblock;
+  struct rfc5444_reader_tlvblock tlvblock;
 
   /*! number of addresses */
   uint8_t num_addr;
@@ -378,6 +408,16 @@ struct rfc5444_reader {
   /*! sorted tree of message/addr consumers */
   struct avl_tree message_consumer;
 
+  /**
+   * per message type offset into _msg_dispatch_list of the NULL
+   * terminated list of its consumers, sorted like message_consumer.
+   * Rebuilt when a message consumer is added or removed.
+   */
+  uint16_t _msg_dispatch[256];
+
+  /*! consumer lists of the dispatch table, NULL if not available */
+  struct rfc5444_reader_tlvblock_consumer **_msg_dispatch_list;
+
   /**
    * Callback triggered when a message should be forwarded
    * @param context message context
@@ -388,27 +428,34 @@ struct rfc5444_reader {
 
   /**
    * Callback to allocate a tlvblock entry
+   * @param parser pointer to parser context
    * @return tlvblock entry, NULL if out of memory
    */
-  struct rfc5444_reader_tlvblock_entry *(*malloc_tlvblock_entry)(void);
+  struct rfc5444_reader_tlvblock_entry *(*malloc_tlvblock_entry)(struct rfc5444_reader *parser);
 
   /**
    * Callback to allocate an addressblock entry
+   * @param parser pointer to parser context
    * @return addressblock entry, NULL if out of memory
    */
-  struct rfc5444_reader_addrblock_entry *(*malloc_addrblock_entry)(void);
+  struct rfc5444_reader_addrblock_entry *(*malloc_addrblock_entry)(struct rfc5444_reader *parser);
 
   /**
    * Free a tlvblock entry
+   * @param parser pointer to parser context
    * @param entry tlvblock entry to free
    */
-  void (*free_tlvblock_entry)(struct rfc5444_reader_tlvblock_entry *entry);
+  void (*free_tlvblock_entry)(struct rfc5444_reader *parser, struct rfc5444_reader_tlvblock_entry *entry);
 
   /**
    * Free an addressblock entry
+   * @param parser pointer to parser context
    * @param entry addressblock entry to free
    */
-  void (*free_addrblock_entry)(struct rfc5444_reader_addrblock_entry *entry);
+  void (*free_addrblock_entry)(struct rfc5444_reader *parser, struct rfc5444_reader_addrblock_entry *entry);
+
+  /*! memory the callbacks above allocate from, NULL for the heap */
+  void *allocator;
 };
 
 EXPORT void rfc5444_reader_init(struct rfc5444_reader *);
@@ -423,6 +470,8 @@ EXPORT void rfc5444_reader_remove_packet_consumer(struct rfc5444_reader *, struc
 EXPORT void rfc5444_reader_remove_message_consumer(struct rfc5444_reader *, struct rfc5444_reader_tlvblock_consumer *);
 
 EXPORT enum rfc5444_result rfc5444_reader_handle_packet(struct rfc5444_reader *parser, const uint8_t *buffer, size_t length);
+EXPORT enum rfc5444_result rfc5444_reader_handle_packet_ctx(
+  struct rfc5444_reader *parser, const uint8_t *buffer, size_t length, void *user_ctx);
 
 /**
  * Call to set the do-not-forward flag in message context
@@ -64,6 +64,8 @@ static struct rfc5444_writer_address *_malloc_address_entry(void);
 static struct rfc5444_writer_addrtlv *_malloc_addrtlv_entry(void);
 static void _free_address_entry(struct rfc5444_writer_address *addr);
 static void _free_addrtlv_entry(struct rfc5444_writer_addrtlv *addrtlv);
+static struct rfc5444_writer_message *_malloc_message_entry(void);
+static void _free_message_entry(struct rfc5444_writer_message *msg);
 
 /**
  * @param type TLV type
@@ -93,6 +95,10 @@ rfc5444_writer_init(struct rfc5444_writer *writer) {
     writer->free_address_entry = _free_address_entry;
   if (!writer->free_addrtlv_entry)
     writer->free_addrtlv_entry = _free_addrtlv_entry;
+  if (!writer->malloc_message_entry)
+    writer->malloc_message_entry = _malloc_message_entry;
+  if (!writer->free_message_entry)
+    writer->free_message_entry = _free_message_entry;
 
   oonf_list_init_head(&writer->_targets);
 
@@ -582,7 +588,7 @@ _get_message(struct rfc5444_writer *writer, uint8_t msgid) {
     return msg;
   }
 
-  if ((msg = calloc(1, sizeof(*msg))) == NULL) {
+  if ((msg = writer->malloc_message_entry()) == NULL) {
     return NULL;
   }
 
@@ -590,7 +596,7 @@ _get_message(struct rfc5444_writer *writer, uint8_t msgid) {
   msg->type = msgid;
   msg->_msgcreator_node.key = &msg->type;
   if (avl_insert(&writer->_msgcreators, &msg->_msgcreator_node)) {
-    free(msg);
+    writer->free_message_entry(msg);
     return NULL;
   }
 
@@ -666,6 +672,17 @@ _rfc5444_writer_free_addresses(struct rfc5444_writer *writer, struct rfc5444_wri
   struct rfc5444_writer_address *addr, *safe_addr;
   struct rfc5444_writer_addrtlv *addrtlv, *safe_addrtlv;
 
+  if (writer->free_all_address_entries) {
+    /* drop all references to the addresses, then release them at once */
+    avl_init(&msg->_addr_tree, avl_comp_netaddr, false);
+    oonf_list_init_head(&msg->_addr_head);
+    oonf_list_init_head(&msg->_non_mandatory_addr_head);
+
+    writer->free_all_address_entries(writer);
+    writer->_addrtlv_used = 0;
+    return;
+  }
+
   avl_remove_all_elements(&msg->_addr_tree, addr, _addr_tree_node, safe_addr) {
     /* remove from list too */
     oonf_list_remove(&addr->_addr_oonf_list_node);
@@ -690,7 +707,7 @@ _lazy_free_message(struct rfc5444_writer *writer, struct rfc5444_writer_message
   if (!msg->_registered && oonf_list_is_empty(&msg->_addr_head) && oonf_list_is_empty(&msg->_msgspecific_tlvtype_head) &&
       avl_is_empty(&msg->_provider_tree)) {
     avl_remove(&writer->_msgcreators, &msg->_msgcreator_node);
-    free(msg);
+    writer->free_message_entry(msg);
   }
 }
 
@@ -729,3 +746,21 @@ static void
 _free_addrtlv_entry(struct rfc5444_writer_addrtlv *addrtlv) {
   free(addrtlv);
 }
+
+/**
+ * Default allocator for message objects.
+ * @return pointer to cleaned message object, NULL if an error happened
+ */
+static struct rfc5444_writer_message *
+_malloc_message_entry(void) {
+  return calloc(1, sizeof(struct rfc5444_writer_message));
+}
+
+/**
+ * Default deallocator for message objects.
+ * @param msg pointer to message object
+ */
+static void
+_free_message_entry(struct rfc5444_writer_message *msg) {
+  free(msg);
+}
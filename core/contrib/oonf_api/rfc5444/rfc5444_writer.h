@@ -556,6 +556,26 @@ struct rfc5444_writer {
    */
   void (*free_addrtlv_entry)(struct rfc5444_writer_addrtlv *addrtlv);
 
+  /**
+   * Callback to release all addresses and address tlvs of the writer
+   * in one step, NULL to release them one by one with
+   * free_address_entry() and free_addrtlv_entry()
+   * @param writer pointer to writer context
+   */
+  void (*free_all_address_entries)(struct rfc5444_writer *writer);
+
+  /**
+   * Callback to allocate a message object, NULL for use calloc()
+   * @return message object, NULL if out of memory
+   */
+  struct rfc5444_writer_message *(*malloc_message_entry)(void);
+
+  /**
+   * Callback to free a message object, NULL for use free()
+   * @param msg message object
+   */
+  void (*free_message_entry)(struct rfc5444_writer_message *msg);
+
   /**
    * target of current generated message
    * only used for target specific message types
@@ -681,6 +701,9 @@ EXPORT enum rfc5444_result rfc5444_writer_create_message(
 EXPORT enum rfc5444_result rfc5444_writer_forward_msg(
   struct rfc5444_writer *writer, struct rfc5444_reader_tlvblock_context *context, const uint8_t *msg, size_t len);
 
+EXPORT enum rfc5444_result rfc5444_writer_add_binary_msg(struct rfc5444_writer *writer, const uint8_t *msg,
+  size_t len, rfc5444_writer_targetselector useIf, void *param);
+
 EXPORT void rfc5444_writer_flush(struct rfc5444_writer *, struct rfc5444_writer_target *, bool);
 
 EXPORT void rfc5444_writer_init(struct rfc5444_writer *);
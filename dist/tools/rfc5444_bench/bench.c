@@ -0,0 +1,479 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   RFC5444 encode/decode microbenchmark
+ *
+ * Encodes corpora of RREQs and RREPs with the AODVv2 writer and decodes them
+ * with the AODVv2 reader, reporting packets per second, packet size, hook
+ * allocations and AODVv2 thread requests per packet. Encoding is run
+ * through the message templates and through the generic OONF writer.
+ *
+ * With -t the message templates are checked instead: every message is
+ * encoded through its template and through the generic writer, the packets
+ * have to be the same and decode back to the message.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+#include "kernel_defines.h"
+
+#include "aodvv2_reader.h"
+#include "aodvv2_writer.h"
+#include "net/aodvv2/conf.h"
+#include "net/aodvv2/lrs.h"
+#include "net/aodvv2/mcmsg.h"
+#include "net/aodvv2/metric.h"
+#include "net/aodvv2/rcs.h"
+#include "net/aodvv2/seqnum.h"
+#include "rfc5444/rfc5444_pool.h"
+
+/**
+ * @brief   Messages of each corpus, as many as the multicast message table
+ *          holds so no RREQ of a pass is taken for a duplicate
+ */
+#define BENCH_CORPUS_SIZE (CONFIG_AODVV2_MCMSG_MAX_ENTRIES)
+
+/**
+ * @brief   Default number of packets of each test
+ */
+#define BENCH_PACKETS (1UL << 20)
+
+typedef struct {
+    uint8_t data[CONFIG_AODVV2_RFC5444_PACKET_SIZE];
+    size_t len;
+} bench_pkt_t;
+
+typedef struct {
+    const char *name;
+    uint8_t msg_type;
+    aodvv2_message_t msgs[BENCH_CORPUS_SIZE];
+    bench_pkt_t pkts[BENCH_CORPUS_SIZE];
+} bench_corpus_t;
+
+static struct rfc5444_writer _writer;
+static struct rfc5444_writer_target _target;
+static uint8_t _writer_msg_buffer[CONFIG_AODVV2_RFC5444_PACKET_SIZE];
+static uint8_t _writer_msg_addrtlvs[CONFIG_AODVV2_RFC5444_ADDR_TLVS_SIZE];
+static uint8_t _writer_pkt_buffer[CONFIG_AODVV2_RFC5444_PACKET_SIZE];
+
+static struct rfc5444_reader _reader;
+static struct rfc5444_reader_pool _reader_pool;
+
+static bench_pkt_t _sent;
+static bool _generic;
+
+static bench_corpus_t _corpora[] = {
+    { .name = "rreq", .msg_type = RFC5444_MSGTYPE_RREQ },
+    { .name = "rrep", .msg_type = RFC5444_MSGTYPE_RREP },
+};
+
+static void _send_packet(struct rfc5444_writer *writer,
+                         struct rfc5444_writer_target *iface, void *buffer,
+                         size_t length)
+{
+    (void)writer;
+    (void)iface;
+
+    if (length > sizeof(_sent.data)) {
+        fprintf(stderr, "packet too large: %zu\n", length);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(_sent.data, buffer, length);
+    _sent.len = length;
+}
+
+/* A postprocessor matching every message makes the AODVv2 writer skip its
+ * message templates and go through rfc5444_writer_create_message() */
+static bool _pp_is_matching(struct rfc5444_writer_postprocessor *pp,
+                            int msg_type)
+{
+    (void)pp;
+    return _generic && msg_type >= 0;
+}
+
+static int _pp_process(struct rfc5444_writer_postprocessor *pp,
+                       struct rfc5444_writer_target *target,
+                       struct rfc5444_writer_message *msg, uint8_t *data,
+                       size_t *length)
+{
+    (void)pp;
+    (void)target;
+    (void)msg;
+    (void)data;
+    (void)length;
+    return 0;
+}
+
+static struct rfc5444_writer_postprocessor _generic_pp = {
+    .is_matching_signature = _pp_is_matching,
+    .process = _pp_process,
+};
+
+static double _now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void _encode(const bench_corpus_t *corpus, unsigned i)
+{
+    aodvv2_message_t msg = corpus->msgs[i];
+
+    _sent.len = 0;
+    if (corpus->msg_type == RFC5444_MSGTYPE_RREQ) {
+        aodvv2_writer_send_rreq(&_writer, &msg);
+    }
+    else {
+        aodvv2_writer_send_rrep(&_writer, &msg);
+    }
+    rfc5444_writer_flush(&_writer, &_target, false);
+}
+
+static void _reset_state(void)
+{
+    aodvv2_lrs_init();
+    aodvv2_mcmsg_init();
+}
+
+static void _build_corpus(bench_corpus_t *corpus)
+{
+    for (unsigned i = 0; i < BENCH_CORPUS_SIZE; i++) {
+        aodvv2_message_t *msg = &corpus->msgs[i];
+
+        memset(msg, 0, sizeof(*msg));
+        msg->msg_hop_limit = aodvv2_metric_max(METRIC_HOP_COUNT);
+        msg->metric_type = CONFIG_AODVV2_DEFAULT_METRIC;
+
+        /* 2001:db8::/64 hosts, every fourth OrigNode announces its /64 */
+        msg->orig_node.addr.u8[0] = 0x20;
+        msg->orig_node.addr.u8[1] = 0x01;
+        msg->orig_node.addr.u8[2] = 0x0d;
+        msg->orig_node.addr.u8[3] = 0xb8;
+        msg->targ_node.addr = msg->orig_node.addr;
+        msg->orig_node.addr.u8[14] = i;
+        msg->orig_node.addr.u8[15] = 0x01;
+        msg->targ_node.addr.u8[14] = i;
+        msg->targ_node.addr.u8[15] = 0x02;
+        msg->orig_node.pfx_len = (i % 4) == 0 ? 64 : 128;
+        msg->targ_node.pfx_len = 128;
+
+        msg->orig_node.seqnum = i + 1;
+        msg->targ_node.seqnum = i + 1;
+        msg->orig_node.metric = i % 8;
+        msg->targ_node.metric = i % 4;
+
+        _encode(corpus, i);
+        if (_sent.len == 0) {
+            fprintf(stderr, "%s %u: no packet generated\n", corpus->name, i);
+            exit(EXIT_FAILURE);
+        }
+        corpus->pkts[i] = _sent;
+    }
+}
+
+static int _write_corpus(const char *dir)
+{
+    for (unsigned c = 0; c < ARRAY_SIZE(_corpora); c++) {
+        for (unsigned i = 0; i < BENCH_CORPUS_SIZE; i++) {
+            char path[256];
+            snprintf(path, sizeof(path), "%s/%s-%02u.bin", dir,
+                     _corpora[c].name, i);
+
+            FILE *f = fopen(path, "wb");
+            if (f == NULL ||
+                fwrite(_corpora[c].pkts[i].data, _corpora[c].pkts[i].len, 1,
+                       f) != 1) {
+                fprintf(stderr, "%s: %s\n", path, strerror(errno));
+                if (f != NULL) {
+                    fclose(f);
+                }
+                return -1;
+            }
+            fclose(f);
+        }
+    }
+    return 0;
+}
+
+static void _print_pkt(const char *name, const bench_pkt_t *pkt)
+{
+    fprintf(stderr, "  %-8s", name);
+    for (size_t i = 0; i < pkt->len; i++) {
+        fprintf(stderr, " %02x", pkt->data[i]);
+    }
+    fputc('\n', stderr);
+}
+
+/* Prefixes are decoded without their host bits */
+static bool _node_equal(const node_data_t *a, const node_data_t *b)
+{
+    return a->pfx_len == b->pfx_len &&
+           ipv6_addr_match_prefix(&a->addr, &b->addr) >= a->pfx_len &&
+           a->seqnum == b->seqnum;
+}
+
+/**
+ * @brief   Encode each message of @p corpus through its template and through
+ *          the generic writer and compare the packets
+ *
+ * The SeqNum is reset before each encode, RREPs take their TargSeqNum from
+ * it. The packets are then decoded by the generic reader.
+ *
+ * @return Number of messages that failed.
+ */
+static unsigned _check_corpus(const bench_corpus_t *corpus)
+{
+    static const ipv6_addr_t sender = {
+        .u8 = { 0xfe, 0x80, [15] = 0x01 },
+    };
+    unsigned failed = 0;
+
+    for (unsigned i = 0; i < BENCH_CORPUS_SIZE; i++) {
+        bench_pkt_t tpl;
+
+        _generic = false;
+        aodvv2_seqnum_init();
+        _encode(corpus, i);
+        tpl = _sent;
+
+        _generic = true;
+        aodvv2_seqnum_init();
+        _encode(corpus, i);
+
+        if (tpl.len != _sent.len || memcmp(tpl.data, _sent.data, tpl.len)) {
+            fprintf(stderr, "%s %u: template and generic writer differ\n",
+                    corpus->name, i);
+            _print_pkt("template", &tpl);
+            _print_pkt("generic", &_sent);
+            failed++;
+            continue;
+        }
+
+        /* A RREP carries the SeqNum of its TargNode router */
+        node_data_t orig = corpus->msgs[i].orig_node;
+        node_data_t targ = corpus->msgs[i].targ_node;
+        if (corpus->msg_type == RFC5444_MSGTYPE_RREP) {
+            targ.seqnum = 1;
+        }
+        else {
+            targ.seqnum = 0;
+        }
+
+        aodvv2_reader_ctx_t ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.sender = sender;
+
+        _reset_state();
+        if (rfc5444_reader_handle_packet_ctx(&_reader, tpl.data, tpl.len,
+                                             &ctx) != RFC5444_OKAY ||
+            ctx.msg.metric_type != corpus->msgs[i].metric_type ||
+            !_node_equal(&ctx.msg.orig_node, &orig) ||
+            !_node_equal(&ctx.msg.targ_node, &targ)) {
+            fprintf(stderr, "%s %u: doesn't decode to the message\n",
+                    corpus->name, i);
+            _print_pkt("packet", &tpl);
+            failed++;
+        }
+    }
+    _generic = false;
+
+    printf("%-6s %u/%u messages encode the same on both writers\n",
+           corpus->name, BENCH_CORPUS_SIZE - failed, BENCH_CORPUS_SIZE);
+    return failed;
+}
+
+static void _report(const char *test, const bench_corpus_t *corpus,
+                    const char *path, unsigned long packets, double secs,
+                    unsigned long bytes, uint32_t allocs, uint32_t requests)
+{
+    printf("%-8s %-6s %-9s %10.0f %9.1f %10.2f %9.2f\n", test, corpus->name,
+           path, packets / secs, (double)bytes / packets, (double)allocs / packets,
+           (double)requests / packets);
+}
+
+static uint32_t _thread_requests(void)
+{
+    return host_thread_stats.rreps + host_thread_stats.forwards +
+           host_thread_stats.route_updates + host_thread_stats.dispatches;
+}
+
+static void _bench_encode(const bench_corpus_t *corpus, unsigned long packets)
+{
+    unsigned long bytes = 0;
+    uint32_t allocs = host_alloc_stats.writer;
+    double start = _now();
+
+    for (unsigned long n = 0; n < packets; n++) {
+        _encode(corpus, n % BENCH_CORPUS_SIZE);
+        bytes += _sent.len;
+    }
+
+    _report("encode", corpus, _generic ? "generic" : "template", packets,
+            _now() - start, bytes, host_alloc_stats.writer - allocs, 0);
+}
+
+static void _bench_decode(const bench_corpus_t *corpus, unsigned long packets)
+{
+    static const ipv6_addr_t sender = {
+        .u8 = { 0xfe, 0x80, [15] = 0x01 },
+    };
+    unsigned long bytes = 0;
+    uint32_t allocs = host_alloc_stats.reader;
+    uint32_t requests = _thread_requests();
+    double secs = 0;
+
+    for (unsigned long n = 0; n < packets; n += BENCH_CORPUS_SIZE) {
+        /* every pass finds the same routing state */
+        _reset_state();
+
+        double start = _now();
+        for (unsigned i = 0; i < BENCH_CORPUS_SIZE; i++) {
+            aodvv2_reader_handle_packet(&_reader, &sender,
+                                        corpus->pkts[i].data,
+                                        corpus->pkts[i].len);
+            bytes += corpus->pkts[i].len;
+        }
+        secs += _now() - start;
+    }
+
+    packets = (packets + BENCH_CORPUS_SIZE - 1) / BENCH_CORPUS_SIZE *
+              BENCH_CORPUS_SIZE;
+    _report("decode", corpus, "generic", packets, secs, bytes,
+            host_alloc_stats.reader - allocs, _thread_requests() - requests);
+}
+
+static void _usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-n packets] [-p] [-c dir] [-t]\n"
+            "  -n packets  packets per test (default %lu)\n"
+            "  -p          use the static RFC5444 pools instead of the heap\n"
+            "  -c dir      write the corpora to dir, as fuzzer seeds\n"
+            "  -t          check the message templates against the generic\n"
+            "              writer instead of benchmarking\n",
+            prog, BENCH_PACKETS);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long packets = BENCH_PACKETS;
+    bool pools = false;
+    const char *corpus_dir = NULL;
+    bool check = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:pc:th")) != -1) {
+        switch (opt) {
+            case 'n':
+                packets = strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                pools = true;
+                break;
+            case 'c':
+                corpus_dir = optarg;
+                break;
+            case 't':
+                check = true;
+                break;
+            default:
+                _usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (packets == 0) {
+        _usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    _writer.msg_buffer = _writer_msg_buffer;
+    _writer.msg_size = sizeof(_writer_msg_buffer);
+    _writer.addrtlv_buffer = _writer_msg_addrtlvs;
+    _writer.addrtlv_size = sizeof(_writer_msg_addrtlvs);
+
+    _target.packet_buffer = _writer_pkt_buffer;
+    _target.packet_size = sizeof(_writer_pkt_buffer);
+    _target.sendPacket = _send_packet;
+
+    if (pools) {
+        rfc5444_writer_pool_attach(&_writer);
+    }
+    rfc5444_writer_init(&_writer);
+    rfc5444_writer_register_target(&_writer, &_target);
+    rfc5444_writer_register_postprocessor(&_writer, &_generic_pp);
+    aodvv2_writer_init(&_writer);
+
+    rfc5444_reader_init(&_reader);
+    if (pools) {
+        rfc5444_reader_pool_attach(&_reader, &_reader_pool);
+    }
+    aodvv2_reader_init(&_reader);
+
+    host_count_writer_allocs(&_writer);
+    host_count_reader_allocs(&_reader);
+
+    aodvv2_seqnum_init();
+    aodvv2_rcs_init();
+    _reset_state();
+
+    for (unsigned c = 0; c < ARRAY_SIZE(_corpora); c++) {
+        _build_corpus(&_corpora[c]);
+    }
+
+    if (corpus_dir != NULL) {
+        return _write_corpus(corpus_dir) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    if (check) {
+        unsigned failed = 0;
+        for (unsigned c = 0; c < ARRAY_SIZE(_corpora); c++) {
+            failed += _check_corpus(&_corpora[c]);
+        }
+        return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    printf("%lu packets per test, %u messages per corpus, %s allocation\n\n",
+           packets, BENCH_CORPUS_SIZE, pools ? "pool" : "heap");
+    printf("%-8s %-6s %-9s %10s %9s %10s %9s\n", "test", "msg", "path",
+           "pkt/s", "bytes/pkt", "allocs/pkt", "reqs/pkt");
+
+    for (unsigned c = 0; c < ARRAY_SIZE(_corpora); c++) {
+        for (int generic = 0; generic <= 1; generic++) {
+            _generic = generic;
+            _bench_encode(&_corpora[c], packets);
+        }
+        _generic = false;
+        _bench_decode(&_corpora[c], packets);
+    }
+
+    if (pools) {
+        struct rfc5444_reader_pool_stats rstats;
+        struct rfc5444_writer_pool_stats wstats;
+
+        rfc5444_reader_pool_get_stats(&_reader_pool, &rstats);
+        rfc5444_writer_pool_get_stats(&wstats);
+        printf("\npool exhaustion: reader %" PRIu32 "/%" PRIu32
+               ", writer %" PRIu32 "/%" PRIu32 "/%" PRIu32 "\n",
+               rstats.tlvs.exhausted, rstats.addrs.exhausted,
+               wstats.addrs.exhausted, wstats.addrtlvs.exhausted,
+               wstats.msgs.exhausted);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   RFC5444 reader fuzz target
+ *
+ * Every input is handed to aodvv2_reader_handle_packet(), the RFC5444
+ * reader with the AODVv2 consumers registered.
+ *
+ * Built with -fsanitize=fuzzer this is a libFuzzer target, with
+ * RFC5444_FUZZ_MAIN defined it reads one input per file given on the command
+ * line, or from stdin, which is what AFL and crash reproduction need.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+
+#include "aodvv2_reader.h"
+#include "net/aodvv2/lrs.h"
+#include "net/aodvv2/mcmsg.h"
+#include "net/aodvv2/rcs.h"
+#include "net/aodvv2/seqnum.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static struct rfc5444_reader _reader;
+
+static const ipv6_addr_t _sender = {
+    .u8 = { 0xfe, 0x80, [15] = 0x01 },
+};
+
+static void _init(void)
+{
+    rfc5444_reader_init(&_reader);
+    aodvv2_reader_init(&_reader);
+
+    aodvv2_seqnum_init();
+    aodvv2_rcs_init();
+    aodvv2_lrs_init();
+    aodvv2_mcmsg_init();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool initialized;
+
+    if (!initialized) {
+        _init();
+        initialized = true;
+    }
+
+    aodvv2_reader_handle_packet(&_reader, &_sender, data, size);
+    return 0;
+}
+
+#ifdef RFC5444_FUZZ_MAIN
+static int _run(FILE *f, const char *name)
+{
+    static uint8_t buf[1 << 16];
+    size_t len = fread(buf, 1, sizeof(buf), f);
+
+    if (ferror(f)) {
+        perror(name);
+        return -1;
+    }
+
+    /* copy the input so out of bounds reads are caught by the sanitizers */
+    uint8_t *data = malloc(len ? len : 1);
+    if (data == NULL) {
+        return -1;
+    }
+    memcpy(data, buf, len);
+    LLVMFuzzerTestOneInput(data, len);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        return _run(stdin, "stdin") < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (f == NULL) {
+            perror(argv[i]);
+            return EXIT_FAILURE;
+        }
+        int res = _run(f, argv[i]);
+        fclose(f);
+        if (res < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+#endif /* RFC5444_FUZZ_MAIN */
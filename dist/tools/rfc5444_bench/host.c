@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host environment of the RFC5444 benchmark and fuzzer
+ */
+
+#include <arpa/inet.h>
+#include <string.h>
+#include <time.h>
+
+#include "host.h"
+
+#include "net/aodvv2.h"
+#include "net/aodvv2/rreq_data.h"
+#include "net/manet.h"
+#include "timex.h"
+#include "xtimer.h"
+
+host_thread_stats_t host_thread_stats;
+host_alloc_stats_t host_alloc_stats;
+
+const ipv6_addr_t ipv6_addr_unspecified;
+ipv6_addr_t ipv6_addr_all_manet_routers_link_local =
+    IPV6_ADDR_ALL_MANET_ROUTERS_LINK_LOCAL;
+
+static struct rfc5444_reader_tlvblock_entry *(*_reader_malloc_tlv)(
+    struct rfc5444_reader *);
+static struct rfc5444_reader_addrblock_entry *(*_reader_malloc_addr)(
+    struct rfc5444_reader *);
+static struct rfc5444_writer_address *(*_writer_malloc_addr)(void);
+static struct rfc5444_writer_addrtlv *(*_writer_malloc_addrtlv)(void);
+static struct rfc5444_writer_message *(*_writer_malloc_msg)(void);
+
+/*
+ * IPv6 addresses
+ */
+
+bool ipv6_addr_equal(const ipv6_addr_t *a, const ipv6_addr_t *b)
+{
+    return memcmp(a, b, sizeof(ipv6_addr_t)) == 0;
+}
+
+uint8_t ipv6_addr_match_prefix(const ipv6_addr_t *a, const ipv6_addr_t *b)
+{
+    uint8_t prefix_len = 0;
+
+    for (unsigned i = 0; i < sizeof(ipv6_addr_t); i++) {
+        uint8_t xor = a->u8[i] ^ b->u8[i];
+        if (xor == 0) {
+            prefix_len += 8;
+            continue;
+        }
+        while ((xor & 0x80) == 0) {
+            prefix_len++;
+            xor <<= 1;
+        }
+        break;
+    }
+
+    return prefix_len;
+}
+
+void ipv6_addr_init_prefix(ipv6_addr_t *out, const ipv6_addr_t *prefix,
+                           uint8_t bits)
+{
+    if (bits > 128) {
+        bits = 128;
+    }
+
+    memset(out, 0, sizeof(ipv6_addr_t));
+    memcpy(out, prefix, bits / 8);
+    if (bits % 8) {
+        out->u8[bits / 8] = prefix->u8[bits / 8] & (0xff << (8 - (bits % 8)));
+    }
+}
+
+char *ipv6_addr_to_str(char *result, const ipv6_addr_t *addr,
+                       uint8_t result_len)
+{
+    return (char *)inet_ntop(AF_INET6, addr, result, result_len);
+}
+
+ipv6_addr_t *ipv6_addr_from_str(ipv6_addr_t *result, const char *addr)
+{
+    return inet_pton(AF_INET6, addr, result) == 1 ? result : NULL;
+}
+
+/*
+ * Time
+ */
+
+timex_t timex_set(uint32_t seconds, uint32_t microseconds)
+{
+    timex_t t = { .seconds = seconds, .microseconds = microseconds };
+    return t;
+}
+
+timex_t timex_add(const timex_t a, const timex_t b)
+{
+    timex_t t = timex_set(a.seconds + b.seconds,
+                          a.microseconds + b.microseconds);
+    if (t.microseconds >= US_PER_SEC) {
+        t.seconds++;
+        t.microseconds -= US_PER_SEC;
+    }
+    return t;
+}
+
+timex_t timex_sub(const timex_t a, const timex_t b)
+{
+    if (a.microseconds >= b.microseconds) {
+        return timex_set(a.seconds - b.seconds,
+                         a.microseconds - b.microseconds);
+    }
+    return timex_set(a.seconds - b.seconds - 1,
+                     a.microseconds + US_PER_SEC - b.microseconds);
+}
+
+int timex_cmp(const timex_t a, const timex_t b)
+{
+    if (a.seconds != b.seconds) {
+        return a.seconds < b.seconds ? -1 : 1;
+    }
+    if (a.microseconds != b.microseconds) {
+        return a.microseconds < b.microseconds ? -1 : 1;
+    }
+    return 0;
+}
+
+void xtimer_now_timex(timex_t *out)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *out = timex_set(ts.tv_sec, ts.tv_nsec / 1000);
+}
+
+/*
+ * AODVv2 thread
+ */
+
+void aodvv2_forward_rreq(aodvv2_message_t *pkt, const ipv6_addr_t *next_hop,
+                         const uint8_t *msg, size_t len,
+                         const uint8_t *metric)
+{
+    (void)next_hop;
+    (void)msg;
+    (void)len;
+    (void)metric;
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    /* The RREQ isn't sent, its packet is given back right away */
+    aodvv2_rreq_data_free(pkt->data);
+#else
+    (void)pkt;
+#endif
+    host_thread_stats.forwards++;
+}
+
+int aodvv2_send_rrep(aodvv2_message_t *pkt, ipv6_addr_t *next_hop)
+{
+    (void)pkt;
+    (void)next_hop;
+    host_thread_stats.rreps++;
+    return 0;
+}
+
+void aodvv2_route_update(const ipv6_addr_t *dst, uint8_t pfx_len,
+                         const ipv6_addr_t *next_hop, uint16_t ltime)
+{
+    (void)dst;
+    (void)pfx_len;
+    (void)next_hop;
+    (void)ltime;
+    host_thread_stats.route_updates++;
+}
+
+bool aodvv2_is_local_addr(const ipv6_addr_t *addr)
+{
+    (void)addr;
+    return false;
+}
+
+void aodvv2_buffer_dispatch(const ipv6_addr_t *targ_addr)
+{
+    (void)targ_addr;
+    host_thread_stats.dispatches++;
+}
+
+int aodvv2_rreq_data_deliver(const uint8_t *data, size_t len,
+                             const node_data_t *targ)
+{
+    (void)data;
+    (void)len;
+    (void)targ;
+    host_thread_stats.deliveries++;
+    return 0;
+}
+
+/*
+ * Allocation counting
+ */
+
+static struct rfc5444_reader_tlvblock_entry *_count_reader_tlv(
+    struct rfc5444_reader *reader)
+{
+    host_alloc_stats.reader++;
+    return _reader_malloc_tlv(reader);
+}
+
+static struct rfc5444_reader_addrblock_entry *_count_reader_addr(
+    struct rfc5444_reader *reader)
+{
+    host_alloc_stats.reader++;
+    return _reader_malloc_addr(reader);
+}
+
+static struct rfc5444_writer_address *_count_writer_addr(void)
+{
+    host_alloc_stats.writer++;
+    return _writer_malloc_addr();
+}
+
+static struct rfc5444_writer_addrtlv *_count_writer_addrtlv(void)
+{
+    host_alloc_stats.writer++;
+    return _writer_malloc_addrtlv();
+}
+
+static struct rfc5444_writer_message *_count_writer_msg(void)
+{
+    host_alloc_stats.writer++;
+    return _writer_malloc_msg();
+}
+
+void host_count_reader_allocs(struct rfc5444_reader *reader)
+{
+    _reader_malloc_tlv = reader->malloc_tlvblock_entry;
+    _reader_malloc_addr = reader->malloc_addrblock_entry;
+
+    reader->malloc_tlvblock_entry = _count_reader_tlv;
+    reader->malloc_addrblock_entry = _count_reader_addr;
+}
+
+void host_count_writer_allocs(struct rfc5444_writer *writer)
+{
+    _writer_malloc_addr = writer->malloc_address_entry;
+    _writer_malloc_addrtlv = writer->malloc_addrtlv_entry;
+    _writer_malloc_msg = writer->malloc_message_entry;
+
+    writer->malloc_address_entry = _count_writer_addr;
+    writer->malloc_addrtlv_entry = _count_writer_addrtlv;
+    writer->malloc_message_entry = _count_writer_msg;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host environment of the RFC5444 benchmark and fuzzer
+ *
+ * Replaces the parts of RIOT and of the AODVv2 thread the reader and writer
+ * callbacks depend on, and counts what the callbacks ask the thread to do.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+#include "rfc5444/rfc5444_reader.h"
+#include "rfc5444/rfc5444_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Requests made to the AODVv2 thread
+ */
+typedef struct {
+    uint32_t rreps;         /**< aodvv2_send_rrep() calls */
+    uint32_t forwards;      /**< aodvv2_forward_rreq() calls */
+    uint32_t route_updates; /**< aodvv2_route_update() calls */
+    uint32_t dispatches;    /**< aodvv2_buffer_dispatch() calls */
+    uint32_t deliveries;    /**< aodvv2_rreq_data_deliver() calls */
+} host_thread_stats_t;
+
+/**
+ * @brief   Allocations made through the reader and writer hooks
+ */
+typedef struct {
+    uint32_t reader;        /**< tlvblock and addrblock entries */
+    uint32_t writer;        /**< addresses, address tlvs and messages */
+} host_alloc_stats_t;
+
+extern host_thread_stats_t host_thread_stats;
+extern host_alloc_stats_t host_alloc_stats;
+
+/**
+ * @brief   Count the allocations of a reader
+ *
+ * Wraps the allocation hooks the reader has, call it after
+ * rfc5444_reader_init().
+ */
+void host_count_reader_allocs(struct rfc5444_reader *reader);
+
+/**
+ * @brief   Count the allocations of a writer
+ *
+ * Wraps the allocation hooks the writer has, call it after
+ * rfc5444_writer_init().
+ */
+void host_count_writer_allocs(struct rfc5444_writer *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_H */
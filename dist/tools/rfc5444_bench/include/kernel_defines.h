@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT kernel_defines.h
+ */
+
+#ifndef KERNEL_DEFINES_H
+#define KERNEL_DEFINES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef container_of
+#define container_of(PTR, TYPE, MEMBER) \
+    ((TYPE *)((char *)(PTR) - offsetof(TYPE, MEMBER)))
+#endif
+
+#define ARRAY_SIZE(a) (sizeof((a)) / sizeof((a)[0]))
+
+#define __PREFIX_WHEN_1 0,
+#define __take_second_arg(__ignored, val, ...) val
+#define __is_defined(x) ___is_defined(x)
+#define ___is_defined(val) ____is_defined(__PREFIX_WHEN_##val)
+#define ____is_defined(arg1_or_junk) __take_second_arg(arg1_or_junk 1, 0)
+
+#define IS_ACTIVE(macro) __is_defined(macro)
+#define IS_USED(module) IS_ACTIVE(module)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KERNEL_DEFINES_H */
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT mutex.h
+ *
+ * The benchmark and the fuzzer are single threaded, locking is a no-op.
+ */
+
+#ifndef MUTEX_H
+#define MUTEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int locked;
+} mutex_t;
+
+#define MUTEX_INIT { 0 }
+
+static inline void mutex_init(mutex_t *mutex) { mutex->locked = 0; }
+static inline void mutex_lock(mutex_t *mutex) { mutex->locked = 1; }
+static inline void mutex_unlock(mutex_t *mutex) { mutex->locked = 0; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MUTEX_H */
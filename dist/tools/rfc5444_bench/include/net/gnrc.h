@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT net/gnrc.h
+ *
+ * Only the types named by the AODVv2 headers, the network stack itself
+ * isn't part of the host build.
+ */
+
+#ifndef NET_GNRC_H
+#define NET_GNRC_H
+
+#include "net/gnrc/netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gnrc_pktsnip gnrc_pktsnip_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_H */
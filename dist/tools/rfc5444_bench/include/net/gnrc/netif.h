@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT net/gnrc/netif.h
+ */
+
+#ifndef NET_GNRC_NETIF_H
+#define NET_GNRC_NETIF_H
+
+#include "mutex.h"
+#include "thread.h"
+#include "xtimer.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct gnrc_netif gnrc_netif_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_NETIF_H */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT net/ipv6/addr.h
+ */
+
+#ifndef NET_IPV6_ADDR_H
+#define NET_IPV6_ADDR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IPV6_ADDR_MAX_STR_LEN (sizeof("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255"))
+
+typedef union {
+    uint8_t u8[16];
+    uint16_t u16[8];
+    uint32_t u32[4];
+    uint64_t u64[2];
+} ipv6_addr_t;
+
+extern const ipv6_addr_t ipv6_addr_unspecified;
+
+static inline bool ipv6_addr_is_unspecified(const ipv6_addr_t *addr)
+{
+    return (addr->u64[0] == 0) && (addr->u64[1] == 0);
+}
+
+bool ipv6_addr_equal(const ipv6_addr_t *a, const ipv6_addr_t *b);
+uint8_t ipv6_addr_match_prefix(const ipv6_addr_t *a, const ipv6_addr_t *b);
+void ipv6_addr_init_prefix(ipv6_addr_t *out, const ipv6_addr_t *prefix,
+                           uint8_t bits);
+char *ipv6_addr_to_str(char *result, const ipv6_addr_t *addr,
+                       uint8_t result_len);
+ipv6_addr_t *ipv6_addr_from_str(ipv6_addr_t *result, const char *addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_IPV6_ADDR_H */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT thread.h
+ */
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int16_t kernel_pid_t;
+
+#define KERNEL_PID_UNDEF (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* THREAD_H */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT timex.h
+ */
+
+#ifndef TIMEX_H
+#define TIMEX_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define US_PER_SEC (1000000U)
+#define US_PER_MS (1000U)
+#define MS_PER_SEC (1000U)
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t microseconds;
+} timex_t;
+
+timex_t timex_add(const timex_t a, const timex_t b);
+timex_t timex_sub(const timex_t a, const timex_t b);
+timex_t timex_set(uint32_t seconds, uint32_t microseconds);
+int timex_cmp(const timex_t a, const timex_t b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMEX_H */
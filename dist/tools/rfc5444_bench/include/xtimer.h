@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Host replacement of the RIOT xtimer.h
+ */
+
+#ifndef XTIMER_H
+#define XTIMER_H
+
+#include "timex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void xtimer_now_timex(timex_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* XTIMER_H */
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @file
+ * @brief   Route choice of Hop Count and ETX on random lossy topologies
+ *
+ * Nodes are dropped on a square, the delivery ratio of a link falls with
+ * distance and differs a little per direction. Every node measures its
+ * links by receiving a window of HELLOs through the AODVv2 Neighbor Set,
+ * the route a RREQ flood finds is the one with the lowest metric as
+ * accumulated by aodvv2_metric_update(), hop limits included.
+ *
+ * Each route is then rated by unicast delivery with MAC retries: a
+ * transmission succeeds when the frame and its ACK get through.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "kernel_defines.h"
+
+#include "net/aodvv2/metric.h"
+#include "net/aodvv2/neigh.h"
+
+/**
+ * @brief   Maximum number of nodes
+ */
+#define SIM_MAX_NODES (64)
+
+/**
+ * @brief   Transmissions of a frame, first one and MAC retries
+ */
+#define SIM_MAC_ATTEMPTS (4)
+
+typedef struct {
+    unsigned nodes;                          /**< Nodes per topology */
+    double range;                            /**< Radio range, side is 1 */
+    double p[SIM_MAX_NODES][SIM_MAX_NODES];  /**< Delivery ratio from i to j */
+    uint8_t cost[SIM_MAX_NODES][SIM_MAX_NODES]; /**< Cost of the link from
+                                                  j as measured by i, 0 if
+                                                  j isn't heard */
+} sim_topology_t;
+
+typedef struct {
+    unsigned routes;        /**< Routes found */
+    double hops;            /**< Sum of hops */
+    double delivery;        /**< Sum of end to end delivery ratios */
+    double tx;              /**< Sum of transmissions per packet sent */
+} sim_result_t;
+
+static sim_topology_t _topo;
+static uint64_t _rand_state = 1;
+
+static double _rand(void)
+{
+    /* xorshift64*, reproducible across hosts */
+    _rand_state ^= _rand_state >> 12;
+    _rand_state ^= _rand_state << 25;
+    _rand_state ^= _rand_state >> 27;
+    return (double)((_rand_state * 2685821657736338717ULL) >> 11) /
+           (double)(1ULL << 53);
+}
+
+static void _node_addr(ipv6_addr_t *addr, unsigned node)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->u8[0] = 0xfe;
+    addr->u8[1] = 0x80;
+    addr->u8[15] = node + 1;
+}
+
+/**
+ * @brief   Number of HELLOs out of a window that get through
+ */
+static unsigned _hellos_rcvd(double p)
+{
+    unsigned rcvd = 0;
+
+    for (unsigned i = 0; i < CONFIG_AODVV2_ETX_WINDOW; i++) {
+        rcvd += _rand() < p;
+    }
+
+    return rcvd;
+}
+
+static void _topology_build(sim_topology_t *topo)
+{
+    double x[SIM_MAX_NODES];
+    double y[SIM_MAX_NODES];
+
+    for (unsigned i = 0; i < topo->nodes; i++) {
+        x[i] = _rand();
+        y[i] = _rand();
+    }
+
+    for (unsigned i = 0; i < topo->nodes; i++) {
+        for (unsigned j = 0; j < topo->nodes; j++) {
+            double d = hypot(x[i] - x[j], y[i] - y[j]) / topo->range;
+            double p = (i == j || d >= 1.0) ? 0.0 : 1.0 - (d * d * d);
+
+            topo->p[i][j] = p * (0.8 + (0.2 * _rand()));
+        }
+    }
+
+    /* Every node measures its neighbors on its own Neighbor Set */
+    for (unsigned i = 0; i < topo->nodes; i++) {
+        aodvv2_neigh_init();
+
+        for (unsigned j = 0; j < topo->nodes; j++) {
+            ipv6_addr_t addr;
+            _node_addr(&addr, j);
+
+            aodvv2_neigh_t *neigh = NULL;
+            for (uint16_t seq = 0; seq < CONFIG_AODVV2_ETX_WINDOW; seq++) {
+                if (_rand() < topo->p[j][i]) {
+                    neigh = aodvv2_neigh_hello_rcvd(&addr, seq, UINT32_MAX,
+                                                    true);
+                }
+            }
+
+            /* The ratio j reports for our HELLOs */
+            unsigned rcvd = _hellos_rcvd(topo->p[i][j]);
+            if (neigh != NULL && rcvd > 0) {
+                neigh->fwd_ratio = (rcvd * AODVV2_NEIGH_RATIO_MAX) /
+                                   CONFIG_AODVV2_ETX_WINDOW;
+            }
+        }
+
+        for (unsigned j = 0; j < topo->nodes; j++) {
+            ipv6_addr_t addr;
+            _node_addr(&addr, j);
+
+            topo->cost[i][j] = 0;
+            if (aodvv2_neigh_get(&addr) != NULL) {
+                topo->cost[i][j] = aodvv2_metric_link_cost(METRIC_LINK_ETX,
+                                                           &addr);
+            }
+        }
+    }
+}
+
+/**
+ * @brief   Route from @p src the RREQ flood of @p metric_type finds
+ *
+ * @return Number of hops to @p dst, 0 if unreachable.
+ */
+static unsigned _route(const sim_topology_t *topo,
+                       routing_metric_t metric_type, unsigned src,
+                       unsigned dst, unsigned *path)
+{
+    unsigned metric[SIM_MAX_NODES];
+    int prev[SIM_MAX_NODES];
+    bool done[SIM_MAX_NODES] = { false };
+    unsigned max = aodvv2_metric_max(metric_type);
+
+    for (unsigned i = 0; i < topo->nodes; i++) {
+        metric[i] = UINT32_MAX;
+        prev[i] = -1;
+    }
+    metric[src] = 0;
+
+    for (;;) {
+        int u = -1;
+        for (unsigned i = 0; i < topo->nodes; i++) {
+            if (!done[i] && metric[i] != UINT32_MAX &&
+                (u < 0 || metric[i] < metric[u])) {
+                u = i;
+            }
+        }
+        if (u < 0) {
+            break;
+        }
+        done[u] = true;
+
+        for (unsigned v = 0; v < topo->nodes; v++) {
+            if (topo->cost[v][u] == 0) {
+                continue;
+            }
+
+            uint8_t link_cost = metric_type == METRIC_LINK_ETX
+                                ? topo->cost[v][u]
+                                : aodvv2_metric_link_cost(metric_type, NULL);
+
+            /* Dropped by the receiver, as aodvv2_reader does */
+            if ((max - link_cost) <= metric[u]) {
+                continue;
+            }
+
+            uint8_t m = metric[u];
+            aodvv2_metric_update(metric_type, link_cost, &m);
+
+            /* Equal Hop Count routes go either way */
+            if (m < metric[v] || (m == metric[v] && _rand() < 0.5)) {
+                metric[v] = m;
+                prev[v] = u;
+            }
+        }
+    }
+
+    if (prev[dst] < 0) {
+        return 0;
+    }
+
+    unsigned hops = 0;
+    for (int n = dst; n != (int)src; n = prev[n]) {
+        path[hops++] = n;
+    }
+    path[hops] = src;
+
+    return hops;
+}
+
+static void _rate(const sim_topology_t *topo, const unsigned *path,
+                  unsigned hops, sim_result_t *res)
+{
+    double reach = 1.0;
+    double tx = 0.0;
+
+    /* path runs from dst back to src */
+    for (unsigned k = hops; k > 0; k--) {
+        unsigned u = path[k];
+        unsigned v = path[k - 1];
+        double p = topo->p[u][v] * topo->p[v][u];
+        double fail = pow(1.0 - p, SIM_MAC_ATTEMPTS);
+
+        tx += reach * (p > 0.0 ? (1.0 - fail) / p : SIM_MAC_ATTEMPTS);
+        reach *= 1.0 - fail;
+    }
+
+    res->routes++;
+    res->hops += hops;
+    res->delivery += reach;
+    res->tx += tx;
+}
+
+static void _report(const char *name, const sim_result_t *res,
+                    double base_goodput)
+{
+    double goodput = res->delivery / res->tx;
+
+    printf("%-10s %7u %7.2f %9.3f %9.2f %9.3f %8.2f\n", name, res->routes,
+           res->hops / res->routes, res->delivery / res->routes,
+           res->tx / res->routes, goodput,
+           base_goodput > 0.0 ? goodput / base_goodput : 1.0);
+}
+
+static void _usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [-n nodes] [-t topologies] [-r range] [-s seed]\n"
+            "  -n nodes       nodes per topology (default 30, max %u)\n"
+            "  -t topologies  random topologies (default 50)\n"
+            "  -r range       radio range, the side of the square is 1 "
+            "(default 0.3)\n"
+            "  -s seed        random seed (default 1)\n",
+            prog, SIM_MAX_NODES);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned topologies = 50;
+    int opt;
+
+    _topo.nodes = 30;
+    _topo.range = 0.3;
+
+    while ((opt = getopt(argc, argv, "n:t:r:s:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                _topo.nodes = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                topologies = strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                _topo.range = strtod(optarg, NULL);
+                break;
+            case 's':
+                _rand_state = strtoull(optarg, NULL, 0) | 1;
+                break;
+            default:
+                _usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (_topo.nodes < 2 || _topo.nodes > SIM_MAX_NODES ||
+        topologies == 0 || _topo.range <= 0.0) {
+        _usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    sim_result_t hop_count = { 0 };
+    sim_result_t etx = { 0 };
+
+    for (unsigned t = 0; t < topologies; t++) {
+        _topology_build(&_topo);
+
+        for (unsigned src = 0; src < _topo.nodes; src++) {
+            for (unsigned dst = 0; dst < _topo.nodes; dst++) {
+                unsigned hc_path[SIM_MAX_NODES + 1];
+                unsigned etx_path[SIM_MAX_NODES + 1];
+
+                if (src == dst) {
+                    continue;
+                }
+
+                /* Only compare pairs both metrics find a route for */
+                unsigned hc_hops = _route(&_topo, METRIC_HOP_COUNT, src, dst,
+                                          hc_path);
+                unsigned etx_hops = _route(&_topo, METRIC_LINK_ETX, src, dst,
+                                           etx_path);
+                if (hc_hops == 0 || etx_hops == 0) {
+                    continue;
+                }
+
+                _rate(&_topo, hc_path, hc_hops, &hop_count);
+                _rate(&_topo, etx_path, etx_hops, &etx);
+            }
+        }
+    }
+
+    if (hop_count.routes == 0) {
+        fprintf(stderr, "no routes found, increase the range\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u topologies of %u nodes, range %.2f, %u MAC attempts\n\n",
+           topologies, _topo.nodes, _topo.range, SIM_MAC_ATTEMPTS);
+    printf("%-10s %7s %7s %9s %9s %9s %8s\n", "metric", "routes", "hops",
+           "delivery", "tx/pkt", "goodput", "relative");
+
+    double base = hop_count.delivery / hop_count.tx;
+    _report("hop-count", &hop_count, base);
+    _report("etx", &etx, base);
+
+    return EXIT_SUCCESS;
+}
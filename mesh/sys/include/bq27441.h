@@ -25,6 +25,8 @@
 #include "periph/i2c.h"
 #include "periph/gpio.h"
 
+#include "timex.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,6 +31,8 @@
 extern "C" {
 #endif
 
+struct rfc5444_reader_pool_stats;
+
 /**
  * @brief   IPC message to send a RREQ
  */
@@ -41,11 +43,71 @@ extern "C" {
  */
 #define AODVV2_MSG_TYPE_SEND_RREP (0x9001)
 
+/**
+ * @brief   IPC message to expire and dispatch buffered packets
+ */
+#define AODVV2_MSG_TYPE_BUFFER_TICK (0x9002)
+
+/**
+ * @brief   IPC message to send the RREQ of the current route discovery
+ *          window
+ */
+#define AODVV2_MSG_TYPE_RREQ_BATCH (0x9003)
+
+/**
+ * @brief   IPC message to send a HELLO
+ */
+#define AODVV2_MSG_TYPE_HELLO (0x9004)
+
+/**
+ * @brief   IPC message to read the battery fuel gauge
+ */
+#define AODVV2_MSG_TYPE_ENERGY_POLL (0x9005)
+
+/**
+ * @brief   IPC message to take the outcomes of unicast transmissions
+ */
+#define AODVV2_MSG_TYPE_LINK_TX (0x9006)
+
+/**
+ * @brief   IPC message to repair the route to a destination we forward
+ *          packets to
+ */
+#define AODVV2_MSG_TYPE_LOCAL_REPAIR (0x9007)
+
+/**
+ * @brief   IPC message to give up the route repairs that found no route
+ */
+#define AODVV2_MSG_TYPE_REPAIR_TIMEOUT (0x9008)
+
+/**
+ * @brief   IPC message to adapt the protocol timers
+ */
+#define AODVV2_MSG_TYPE_TIMERS_ADAPT (0x9009)
+
 typedef struct {
     aodvv2_message_t pkt; /**< Packet to send */
     ipv6_addr_t next_hop; /**< Next hop */
 } aodvv2_msg_t;
 
+/**
+ * @brief   Number of buckets of the event loop histograms
+ *
+ * Bucket `n` counts values in `[2^n, 2^(n + 1))`, the last one also counts
+ * everything above.
+ */
+#define AODVV2_BATCH_HIST_BUCKETS (6)
+
+/**
+ * @brief   Event loop statistics
+ */
+typedef struct {
+    uint32_t queue_depth[AODVV2_BATCH_HIST_BUCKETS]; /**< Queued messages on
+                                                          wake up */
+    uint32_t batch_size[AODVV2_BATCH_HIST_BUCKETS];  /**< Messages handled
+                                                          per batch */
+} aodvv2_batch_stats_t;
+
 /**
  * @brief   Initialize and start RFC5444
  *
@@ -68,6 +130,27 @@ int aodvv2_init(gnrc_netif_t *netif);
  */
 int aodvv2_send_rreq(aodvv2_message_t *pkt, ipv6_addr_t *next_hop);
 
+/**
+ * @brief   Forward a received RREQ
+ *
+ * The received message is copied and its hop limit and OrigNode metric are
+ * replaced with the ones on @p pkt, if that isn't possible the RREQ is
+ * encoded again from @p pkt.
+ *
+ * @pre (@p pkt != NULL) && (@p next_hop != NULL) && (@p msg != NULL)
+ * @pre Called from the AODVv2 thread.
+ *
+ * @param[in] pkt      The RREQ packet, with hop limit and metric updated.
+ * @param[in] next_hop Where to send the RREQ, all MANET routers or the next
+ *                     hop of a known route to TargNode.
+ * @param[in] msg      The received RFC5444 message.
+ * @param[in] len      Length of @p msg.
+ * @param[in] metric   OrigNode metric TLV value on @p msg, NULL if unknown.
+ */
+void aodvv2_forward_rreq(aodvv2_message_t *pkt, const ipv6_addr_t *next_hop,
+                         const uint8_t *msg, size_t len,
+                         const uint8_t *metric);
+
 /**
  * @brief   Send a RREP
  *
@@ -80,9 +163,61 @@ int aodvv2_send_rreq(aodvv2_message_t *pkt, ipv6_addr_t *next_hop);
  */
 int aodvv2_send_rrep(aodvv2_message_t *pkt, ipv6_addr_t *next_hop);
 
+/**
+ * @brief   Add or replace a route on the NIB forwarding table
+ *
+ * The update is applied when the current batch of received messages is
+ * flushed, a later update of the same route in the batch replaces it.
+ *
+ * @pre @p dst != NULL && @p next_hop != NULL
+ *
+ * @note Only call this from the AODVv2 thread.
+ *
+ * @param[in] dst      Route destination.
+ * @param[in] pfx_len  Destination prefix length.
+ * @param[in] next_hop Next hop.
+ * @param[in] ltime    Route lifetime in seconds.
+ */
+void aodvv2_route_update(const ipv6_addr_t *dst, uint8_t pfx_len,
+                         const ipv6_addr_t *next_hop, uint16_t ltime);
+
+/**
+ * @brief   Check if an address is assigned to the AODVv2 interface
+ *
+ * @pre @p addr != NULL
+ *
+ * @param[in] addr The address.
+ *
+ * @return true if @p addr is one of our addresses.
+ */
+bool aodvv2_is_local_addr(const ipv6_addr_t *addr);
+
+/**
+ * @brief   Get the event loop statistics
+ *
+ * @pre @p stats != NULL
+ *
+ * @param[out] stats The statistics.
+ */
+void aodvv2_batch_stats_get(aodvv2_batch_stats_t *stats);
+
+/**
+ * @brief   Get the usage statistics of the RFC5444 reader pools
+ *
+ * All zero when the reader allocates from the heap.
+ *
+ * @pre @p stats != NULL
+ *
+ * @param[out] stats The statistics.
+ */
+void aodvv2_reader_pool_stats_get(struct rfc5444_reader_pool_stats *stats);
+
 /**
  * @brief   Initiate a route discovery process to find the given address.
  *
+ * Discoveries of the same OrigNode started within
+ * @ref CONFIG_AODVV2_RREQ_BATCH_MS share a single RREQ.
+ *
  * @pre @p target_addr != NULL && @p orig_addr != NULL
  *
  * @param[in] target_addr The IP address where we want a route to.
@@ -92,18 +227,45 @@ int aodvv2_send_rrep(aodvv2_message_t *pkt, ipv6_addr_t *next_hop);
 int aodvv2_find_route(const ipv6_addr_t *orig_addr,
                       const ipv6_addr_t *target_addr);
 
+/**
+ * @brief   Send the packet carried on a RREQ to its destination
+ *
+ * Called by the router answering the RREQ for @p targ, one of its Router
+ * Clients.
+ *
+ * @pre @p data != NULL && @p targ != NULL
+ *
+ * @param[in] data The packet carried on the RREQ.
+ * @param[in] len  Length of @p data.
+ * @param[in] targ TargNode of the RREQ being answered.
+ *
+ * @return 0 on success.
+ * @return -1 if the packet isn't for @p targ or couldn't be sent.
+ */
+int aodvv2_rreq_data_deliver(const uint8_t *data, size_t len,
+                             const node_data_t *targ);
+
 /**
  * @brief   Initialize the AODVv2 packer buffering code.
+ *
+ * @param[in] pid PID of the thread receiving @ref AODVV2_MSG_TYPE_BUFFER_TICK
+ *                messages.
  */
-void aodvv2_buffer_init(void);
+void aodvv2_buffer_init(kernel_pid_t pid);
 
 /**
  * @brief   Add a packet to the packet buffer
  *
  * @pre @p dst != NULL && @p pkt != NULL
  *
+ * If the buffer is full the oldest packets are dropped to make room for
+ * @p pkt.
+ *
  * @brief[in] dst Packet destination address.
  * @brief[in] pkt Packet.
+ *
+ * @return 0 on success.
+ * @return -1 if the packet couldn't be buffered.
  */
 int aodvv2_buffer_pkt_add(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt);
 
@@ -112,10 +274,31 @@ int aodvv2_buffer_pkt_add(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt);
  *
  * @notes Only call this when a route to `targ_addr` is on the NIB
  *
+ * Packets are sent one at a time from @ref aodvv2_buffer_tick, spaced by
+ * @ref CONFIG_AODVV2_BUFFER_DISPATCH_INTERVAL_MS.
+ *
  * @param[in] targ_addr Target address to dispatch packets.
  */
 void aodvv2_buffer_dispatch(const ipv6_addr_t *targ_addr);
 
+/**
+ * @brief   Drop the packets buffered for `dst`
+ *
+ * Each packet is answered with an ICMPv6 Destination Unreachable
+ * (Address unreachable) message, as no route to `dst` will be found.
+ *
+ * @param[in] dst Destination address of the packets.
+ */
+void aodvv2_buffer_drop(const ipv6_addr_t *dst);
+
+/**
+ * @brief   Expire old packets and send pending ones
+ *
+ * @notes Call this when a @ref AODVV2_MSG_TYPE_BUFFER_TICK message is
+ * received.
+ */
+void aodvv2_buffer_tick(void);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
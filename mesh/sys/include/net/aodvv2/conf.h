@@ -61,5 +61,66 @@
 #define CONFIG_AODVV2_RREQ_HOLDDOWN_TIME (10)
 #endif
 
+/**
+ * @brief   Maximum number of packets waiting for a route
+ */
+#ifndef CONFIG_AODVV2_MAX_BUFFERED_PACKETS
+#define CONFIG_AODVV2_MAX_BUFFERED_PACKETS (10)
+#endif
+
+/**
+ * @brief   Maximum number of destinations with packets waiting for a route
+ */
+#ifndef CONFIG_AODVV2_BUFFER_MAX_DESTINATIONS
+#define CONFIG_AODVV2_BUFFER_MAX_DESTINATIONS (4)
+#endif
+
+/**
+ * @brief   Maximum number of packets buffered for a single destination
+ */
+#ifndef CONFIG_AODVV2_BUFFER_MAX_PER_DESTINATION
+#define CONFIG_AODVV2_BUFFER_MAX_PER_DESTINATION (5)
+#endif
+
+/**
+ * @brief   Percentage of the packet buffer that buffered packets can occupy
+ */
+#ifndef CONFIG_AODVV2_BUFFER_PKTBUF_SHARE
+#define CONFIG_AODVV2_BUFFER_PKTBUF_SHARE (25)
+#endif
+
+/**
+ * @brief   Time in seconds a packet can wait for a route
+ */
+#ifndef CONFIG_AODVV2_BUFFER_PKT_LIFETIME
+#define CONFIG_AODVV2_BUFFER_PKT_LIFETIME (3 * CONFIG_AODVV2_RREQ_WAIT_TIME)
+#endif
+
+/**
+ * @brief   Time in milliseconds between buffered packets sent once a route
+ *          is found
+ */
+#ifndef CONFIG_AODVV2_BUFFER_DISPATCH_INTERVAL_MS
+#define CONFIG_AODVV2_BUFFER_DISPATCH_INTERVAL_MS (10)
+#endif
+
+/**
+ * @brief   Time in milliseconds a route discovery waits for others of the
+ *          same OrigNode to share its RREQ, 0 sends each RREQ right away
+ */
+#ifndef CONFIG_AODVV2_RREQ_BATCH_MS
+#define CONFIG_AODVV2_RREQ_BATCH_MS (20)
+#endif
+
+/**
+ * @brief   Hop limit of the RREQs that repair a broken route at an
+ *          intermediate router
+ *
+ * Only used with CONFIG_AODVV2_LOCAL_REPAIR.
+ */
+#ifndef CONFIG_AODVV2_LOCAL_REPAIR_HOP_LIMIT
+#define CONFIG_AODVV2_LOCAL_REPAIR_HOP_LIMIT (3)
+#endif
+
 #endif /* AODVV2_CONF_H */
 /** @} */
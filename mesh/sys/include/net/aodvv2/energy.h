@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 node energy
+ *
+ * Caches the readings of the battery fuel gauge, used by the Node Energy
+ * metric and to stop forwarding RREQs when the battery is critically low.
+ * Without a fuel gauge the node is taken to be mains powered.
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ */
+
+#ifndef NET_AODVV2_ENERGY_H
+#define NET_AODVV2_ENERGY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel_defines.h"
+
+#if IS_USED(MODULE_BQ27441) || defined(DOXYGEN)
+#include "bq27441.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Interval between fuel gauge readings in seconds
+ */
+#ifndef CONFIG_AODVV2_ENERGY_POLL_INTERVAL
+#define CONFIG_AODVV2_ENERGY_POLL_INTERVAL (60)
+#endif
+
+/**
+ * @brief   State of charge in percent at and below which the battery is
+ *          critically low
+ */
+#ifndef CONFIG_AODVV2_ENERGY_CRITICAL_SOC
+#define CONFIG_AODVV2_ENERGY_CRITICAL_SOC (10)
+#endif
+
+/**
+ * @brief   State of charge when there's no fuel gauge or it wasn't read yet
+ */
+#define AODVV2_ENERGY_SOC_UNKNOWN (UINT8_MAX)
+
+/**
+ * @brief   Initialize the node energy cache
+ */
+void aodvv2_energy_init(void);
+
+#if IS_USED(MODULE_BQ27441) || defined(DOXYGEN)
+/**
+ * @brief   Set the fuel gauge of the node battery
+ *
+ * @pre @p dev was initialized with bq27441_init().
+ *
+ * @param[in] dev Fuel gauge, NULL to stop reading it.
+ */
+void aodvv2_energy_set_gauge(bq27441_t *dev);
+#endif
+
+/**
+ * @brief   Read the fuel gauge and update the cached values
+ *
+ * @note Only call this from the AODVv2 thread, it may block for a few
+ *       milliseconds on the I2C bus.
+ */
+void aodvv2_energy_update(void);
+
+/**
+ * @brief   Cached state of charge
+ *
+ * @return State of charge in percent, @ref AODVV2_ENERGY_SOC_UNKNOWN if
+ *         unknown.
+ */
+uint8_t aodvv2_energy_soc(void);
+
+/**
+ * @brief   Is the battery being charged?
+ *
+ * @return true if the battery is charging, the node doesn't spend it.
+ */
+bool aodvv2_energy_is_charging(void);
+
+/**
+ * @brief   Is the battery critically low?
+ *
+ * @return true if discharging at or below
+ *         @ref CONFIG_AODVV2_ENERGY_CRITICAL_SOC.
+ */
+bool aodvv2_energy_is_critical(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NET_AODVV2_ENERGY_H */
+/** @} */
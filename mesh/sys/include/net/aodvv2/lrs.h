@@ -23,6 +23,8 @@
 
 #include <string.h>
 
+#include "kernel_defines.h"
+
 #include "net/aodvv2/rfc5444.h"
 #include "net/aodvv2/seqnum.h"
 #include "net/metric.h"
@@ -42,6 +44,15 @@ extern "C" {
 #endif
 /** @} */
 
+/**
+ * @brief   Maximum number of alternate next hops kept per Local Route
+ *
+ * Only used with CONFIG_AODVV2_MULTIPATH.
+ */
+#ifndef CONFIG_AODVV2_LRS_ALTERNATES
+#define CONFIG_AODVV2_LRS_ALTERNATES (2)
+#endif
+
 /**
  * A route table entry (i.e., a route) may be in one of the following states:
  */
@@ -53,6 +64,15 @@ enum aodvv2_routing_state {
     ROUTE_STATE_TIMED
 };
 
+/**
+ * @brief   An alternate next hop of a Local Route
+ */
+typedef struct {
+    ipv6_addr_t next_hop;         /**< Next hop IP address towards the destination */
+    uint8_t metric;               /**< Metric of the route through it */
+    uint8_t adv_metric;           /**< Metric the next hop advertised */
+} aodvv2_alt_hop_t;
+
 /**
  * @brief   A Local Route
  */
@@ -66,6 +86,13 @@ typedef struct {
     routing_metric_t metric_type; /**< Metric type of this route */
     uint8_t metric;               /**< Metric value of this route*/
     uint8_t state;                /**< State of this route */
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH) || defined(DOXYGEN)
+    /**
+     * @brief   Loop-free alternate next hops with the same SeqNum, best first
+     */
+    aodvv2_alt_hop_t alts[CONFIG_AODVV2_LRS_ALTERNATES];
+    uint8_t num_alts;             /**< Number of @ref alts */
+#endif
 } aodvv2_local_route_t;
 
 /**
@@ -103,6 +130,34 @@ void aodvv2_lrs_add_entry(aodvv2_local_route_t *entry);
 aodvv2_local_route_t *aodvv2_lrs_get_entry(ipv6_addr_t *addr,
                                            routing_metric_t metric_type);
 
+/**
+ * @brief     Mark the Local Routes through a next hop as Broken
+ *
+ * @param[in] next_hop Next hop the link to is broken.
+ *
+ * @return Number of routes that were Broken.
+ */
+unsigned aodvv2_lrs_set_broken(const ipv6_addr_t *next_hop);
+
+/**
+ * @brief     Switch the next Local Route through a next hop to its best
+ *            alternate
+ *
+ * Alternates through @p next_hop are dropped from the routes looked at. A
+ * route that still has an alternate keeps its state and metric, so the
+ * ones that relied on our metric being loop-free still do, the others are
+ * left to aodvv2_lrs_set_broken(). Call it until it returns NULL to switch
+ * all of them.
+ *
+ * @param[in] next_hop Next hop the link to is broken.
+ *
+ * @return The route that switched, valid until the Local Route Set
+ *         changes.
+ * @return NULL if no route is left to switch, always without
+ *         CONFIG_AODVV2_MULTIPATH.
+ */
+aodvv2_local_route_t *aodvv2_lrs_failover(const ipv6_addr_t *next_hop);
+
 /**
  * @brief     Delete Local Route entry towards addr with metric type MetricType,
  *            if it exists.
@@ -124,27 +179,50 @@ void aodvv2_lrs_delete_entry(ipv6_addr_t *addr, routing_metric_t metric_type);
 bool aodvv2_lrs_offers_improvement(aodvv2_local_route_t *rt_entry,
                                    node_data_t *node_data);
 
+/**
+ * @brief   Keep the data of a RREQ or RREP that offers no improvement as an
+ *          alternate next hop of a Local Route
+ *
+ * It's kept if it has the same SeqNum as the route and the metric
+ * @p next_hop advertised is lower than the one of the route, so a packet
+ * sent through it can't come back. The worst alternate is replaced when
+ * there's no room left.
+ *
+ * @param[in] rt_entry  The Local Route.
+ * @param[in] node_data The data, its metric including the cost of the link
+ *                      it was received on.
+ * @param[in] next_hop  The neighbor it was received from.
+ * @param[in] link_cost The cost of the link to @p next_hop.
+ *
+ * @return true if it was kept, always false without CONFIG_AODVV2_MULTIPATH.
+ */
+bool aodvv2_lrs_add_alternate(aodvv2_local_route_t *rt_entry,
+                              const node_data_t *node_data,
+                              const ipv6_addr_t *next_hop, uint8_t link_cost);
+
 /**
  * @brief   Fills a Local Route entry with the data of a RREQ.
  *
+ * The metric of @p msg must already include the cost of the link it was
+ * received on, see aodvv2_metric_update().
+ *
  * @param[in]  msg       The RREQ's data
  * @param[out] rt_entry  The Local Route entry to fill
- * @param[in]  link_cost The link cost for this RREQ
  */
 void aodvv2_lrs_fill_routing_entry_rreq(aodvv2_message_t *msg,
-                                        aodvv2_local_route_t *rt_entry,
-                                        uint8_t link_cost);
+                                        aodvv2_local_route_t *rt_entry);
 
 /**
  * @brief   Fills a Local Route entry with the data of a RREP.
  *
+ * The metric of @p msg must already include the cost of the link it was
+ * received on, see aodvv2_metric_update().
+ *
  * @param[in]  msg       The RREP's data
  * @param[out] rt_entry  The Local Route entry to fill
- * @param[in]  link_cost The link cost for this RREP
  */
 void aodvv2_lrs_fill_routing_entry_rrep(aodvv2_message_t *msg,
-                                        aodvv2_local_route_t *rt_entry,
-                                        uint8_t link_cost);
+                                        aodvv2_local_route_t *rt_entry);
 
 #ifdef __cplusplus
 } /* extern "C" */
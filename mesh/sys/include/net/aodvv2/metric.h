@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "net/ipv6/addr.h"
 #include "net/metric.h"
 
 #ifdef __cplusplus
@@ -49,16 +50,97 @@ extern "C" {
 #endif
 /** @} */
 
+/**
+ * @name    Maximum value for "ETX" metric
+ * @{
+ */
+#ifndef CONFIG_METRIC_LINK_ETX_AODVV2_MAX
+#define CONFIG_METRIC_LINK_ETX_AODVV2_MAX (255)
+#endif
+/** @} */
+
+/**
+ * @name    Maximum value for "Link Quality Level" metric
+ * @{
+ */
+#ifndef CONFIG_METRIC_LINK_QUALITY_LEVEL_AODVV2_MAX
+#define CONFIG_METRIC_LINK_QUALITY_LEVEL_AODVV2_MAX (255)
+#endif
+/** @} */
+
+/**
+ * @name    Maximum value for "Node Energy" metric
+ * @{
+ */
+#ifndef CONFIG_METRIC_NODE_ENERGY_AODVV2_MAX
+#define CONFIG_METRIC_NODE_ENERGY_AODVV2_MAX (255)
+#endif
+/** @} */
+
+/**
+ * @brief   RSSI in dBm at and below which a link has the lowest quality
+ */
+#ifndef CONFIG_AODVV2_LQL_RSSI_MIN
+#define CONFIG_AODVV2_LQL_RSSI_MIN (-94)
+#endif
+
+/**
+ * @brief   RSSI in dBm at and above which a link has the highest quality
+ */
+#ifndef CONFIG_AODVV2_LQL_RSSI_MAX
+#define CONFIG_AODVV2_LQL_RSSI_MAX (-60)
+#endif
+
 #define AODVV2_METRIC_HOP_COUNT_COST (1) /**< Cost for "Hop Count" metric */
 
+/**
+ * @name    Link costs for "ETX" metric
+ *
+ * The cost of a link is its expected transmission count, in units of
+ * @ref AODVV2_METRIC_ETX_UNIT.
+ * @{
+ */
+#define AODVV2_METRIC_ETX_UNIT         (8) /**< Link without losses */
+#define AODVV2_METRIC_ETX_LINK_MAX     (8 * AODVV2_METRIC_ETX_UNIT) /**< Highest */
+#define AODVV2_METRIC_ETX_LINK_UNKNOWN (2 * AODVV2_METRIC_ETX_UNIT) /**< Not measured */
+/** @} */
+
+/**
+ * @name    Link costs for "Link Quality Level" metric
+ *
+ * The cost of a link is its RFC 6551 Link Quality Level, from 1 (highest
+ * quality) to 7 (lowest quality), taken from the averages of the RSSI and
+ * LQI of the frames received from the neighbor.
+ * @{
+ */
+#define AODVV2_METRIC_LQL_LINK_BEST    (1) /**< Highest quality */
+#define AODVV2_METRIC_LQL_LINK_WORST   (7) /**< Lowest quality */
+#define AODVV2_METRIC_LQL_LINK_UNKNOWN (4) /**< Not measured */
+/** @} */
+
+/**
+ * @name    Link costs for "Node Energy" metric
+ *
+ * The cost is the one of the receiving node, which relays the message. It
+ * rises with the square of the charge drained from its battery, so nodes
+ * only start being avoided as they run low. Nodes that are charging or
+ * without a fuel gauge cost as a single hop.
+ * @{
+ */
+#define AODVV2_METRIC_ENERGY_LINK_MIN  (1)  /**< Full battery */
+#define AODVV2_METRIC_ENERGY_LINK_MAX  (16) /**< Empty battery */
+/** @} */
+
 /**
  * @brief   Link cost for the given metric type. Cost(L)
  *
  * @param[in] metric_type Metric type.
+ * @param[in] neighbor    Neighbor at the other end of the link.
  *
  * @return Cost associated with the metric.
  */
-uint8_t aodvv2_metric_link_cost(routing_metric_t metric_type);
+uint8_t aodvv2_metric_link_cost(routing_metric_t metric_type,
+                                const ipv6_addr_t *neighbor);
 
 /**
  * @brief   Analyzes if a route is loop free given the metric. LoopFree(R1, R2)
@@ -89,12 +171,17 @@ uint8_t aodvv2_metric_max(routing_metric_t metric_type);
 /**
  * @brief   Update the value of th provided metric.
  *
+ * Adds the cost of the link the message was received on, saturating at
+ * the maximum value of the metric.
+ *
  * @pre @p metric != NULL
  *
  * @param[in] metric_type The type of the metric to update.
+ * @param[in] link_cost   Cost of the link, see aodvv2_metric_link_cost().
  * @param[inout] metric   The current value of the metric which will be updated.
  */
-void aodvv2_metric_update(routing_metric_t metric_type, uint8_t *metric);
+void aodvv2_metric_update(routing_metric_t metric_type, uint8_t link_cost,
+                          uint8_t *metric);
 
 #ifdef __cplusplus
 } /* extern "C" */
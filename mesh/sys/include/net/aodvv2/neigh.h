@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 Neighbor Set
+ *
+ * Keeps the link quality measured towards each one-hop neighbor, either
+ * from HELLOs or from the RSSI and LQI of received frames. Neighbors are
+ * identified by the (link-local) address they send from.
+ *
+ * HELLOs follow the format of NHDP (RFC 6130): each one lists the neighbors
+ * heard by the sender, so a link is known to be symmetric when the HELLOs
+ * of a neighbor list us. A neighbor not heard within the validity time its
+ * last HELLO announced is lost.
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ */
+
+#ifndef NET_AODVV2_NEIGH_H
+#define NET_AODVV2_NEIGH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "net/ipv6/addr.h"
+
+#include "timex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Maximum number of entries on the Neighbor Set
+ */
+#ifndef CONFIG_AODVV2_NEIGH_ENTRIES
+#define CONFIG_AODVV2_NEIGH_ENTRIES (8)
+#endif
+
+/**
+ * @brief   Minimum interval between HELLOs in seconds
+ *
+ * HELLOs are sent this often after the Neighbor Set changes.
+ */
+#ifndef CONFIG_AODVV2_HELLO_INTERVAL_MIN
+#define CONFIG_AODVV2_HELLO_INTERVAL_MIN (2)
+#endif
+
+/**
+ * @brief   Maximum interval between HELLOs in seconds
+ *
+ * The interval doubles on every HELLO up to this value while the Neighbor
+ * Set doesn't change.
+ */
+#ifndef CONFIG_AODVV2_HELLO_INTERVAL_MAX
+#define CONFIG_AODVV2_HELLO_INTERVAL_MAX (16)
+#endif
+
+/**
+ * @brief   Time in seconds a neighbor heard without HELLOs is kept
+ */
+#ifndef CONFIG_AODVV2_NEIGH_HOLD_TIME
+#define CONFIG_AODVV2_NEIGH_HOLD_TIME (60)
+#endif
+
+/**
+ * @brief   Number of HELLOs the delivery ratios are measured over
+ */
+#ifndef CONFIG_AODVV2_ETX_WINDOW
+#define CONFIG_AODVV2_ETX_WINDOW (10)
+#endif
+
+/**
+ * @brief   Weight of a new RSSI or LQI sample on the averages, 1 / 2^N
+ */
+#ifndef CONFIG_AODVV2_LQL_EWMA_SHIFT
+#define CONFIG_AODVV2_LQL_EWMA_SHIFT (3)
+#endif
+
+/**
+ * @brief   Consecutive unacknowledged unicast frames after which the link to
+ *          a neighbor is broken
+ */
+#ifndef CONFIG_AODVV2_LINK_BREAK_FAILURES
+#define CONFIG_AODVV2_LINK_BREAK_FAILURES (3)
+#endif
+
+/**
+ * @brief   Validity time announced on a HELLO, in intervals to the next one
+ */
+#define AODVV2_NEIGH_HELLO_VALIDITY (3)
+
+/**
+ * @brief   HELLOs of a neighbor in a row not listing us after which the link
+ *          isn't symmetric
+ */
+#define AODVV2_NEIGH_SYM_MISSES (2)
+
+/**
+ * @brief   Delivery ratio of a link without losses
+ */
+#define AODVV2_NEIGH_RATIO_MAX (255)
+
+/**
+ * @brief   Fractional bits of the RSSI and LQI averages
+ */
+#define AODVV2_NEIGH_EWMA_FRAC (4)
+
+/**
+ * @name    Values of a frame without RSSI or LQI
+ *
+ * Same as the ones GNRC uses on its netif header.
+ * @{
+ */
+#define AODVV2_NEIGH_NO_RSSI (INT16_MIN)
+#define AODVV2_NEIGH_NO_LQI  (0)
+/** @} */
+
+/**
+ * @brief   State of the link to a neighbor
+ */
+typedef enum {
+    AODVV2_NEIGH_LINK_UNKNOWN = 0, /**< No HELLO received from the neighbor */
+    AODVV2_NEIGH_LINK_HEARD,       /**< Its HELLOs don't list us */
+    AODVV2_NEIGH_LINK_SYMMETRIC,   /**< Its HELLOs list us */
+} aodvv2_neigh_link_t;
+
+/**
+ * @brief   A neighbor
+ */
+typedef struct {
+    ipv6_addr_t addr;       /**< Address the neighbor sends from */
+    timex_t last_heard;     /**< Last time the neighbor was heard */
+    timex_t expires;        /**< Time the neighbor is lost if not heard */
+    timex_t blacklisted;    /**< Time the neighbor is blacklisted until */
+    uint8_t link;           /**< State of the link, one of
+                                 @ref aodvv2_neigh_link_t */
+    bool heard;             /**< Was anything received from the neighbor? */
+    uint8_t sym_misses;     /**< HELLOs in a row that didn't list us */
+    uint16_t hello_seqnum;  /**< SeqNum of the last HELLO received */
+    uint16_t hello_rcvd;    /**< HELLOs received, bit 0 is the last one */
+    uint8_t hello_span;     /**< Number of HELLOs covered by @ref hello_rcvd */
+    uint8_t rev_ratio;      /**< Delivery ratio from the neighbor to us */
+    uint8_t fwd_ratio;      /**< Delivery ratio from us to the neighbor, as
+                                 reported by it, 0 if unknown */
+    int16_t rssi_avg;       /**< Average RSSI in dBm, with
+                                 @ref AODVV2_NEIGH_EWMA_FRAC fractional bits */
+    uint16_t lqi_avg;       /**< Average LQI, with
+                                 @ref AODVV2_NEIGH_EWMA_FRAC fractional bits */
+    bool has_rssi;          /**< Is @ref rssi_avg valid? */
+    bool has_lqi;           /**< Is @ref lqi_avg valid? */
+    uint8_t tx_failures;    /**< Consecutive unacknowledged unicast frames */
+} aodvv2_neigh_t;
+
+/**
+ * @brief   Callback for lost neighbors
+ *
+ * @param[in] addr Address of the neighbor.
+ */
+typedef void (*aodvv2_neigh_lost_cb_t)(const ipv6_addr_t *addr);
+
+/**
+ * @brief   Initialize the Neighbor Set
+ */
+void aodvv2_neigh_init(void);
+
+/**
+ * @brief   Set the callback for neighbors that are lost
+ *
+ * Called when a neighbor isn't heard within its validity time, before it's
+ * removed from the set.
+ *
+ * @param[in] cb The callback, NULL to remove it.
+ */
+void aodvv2_neigh_set_lost_cb(aodvv2_neigh_lost_cb_t cb);
+
+/**
+ * @brief   Get a neighbor
+ *
+ * @param[in] addr Address of the neighbor.
+ *
+ * @return The neighbor, NULL if it isn't known.
+ */
+aodvv2_neigh_t *aodvv2_neigh_get(const ipv6_addr_t *addr);
+
+/**
+ * @brief   Account a HELLO received from a neighbor
+ *
+ * The neighbor is added if it isn't known, replacing the one heard least
+ * recently if the set is full. Parts of a HELLO too large for one message
+ * share the SeqNum, so @p listed is taken from any of them.
+ *
+ * @param[in] addr     Address of the neighbor.
+ * @param[in] seqnum   SeqNum of the HELLO.
+ * @param[in] validity Validity time of the HELLO in milliseconds.
+ * @param[in] listed   true if the HELLO lists us as heard or symmetric.
+ *
+ * @return The neighbor.
+ */
+aodvv2_neigh_t *aodvv2_neigh_hello_rcvd(const ipv6_addr_t *addr,
+                                        uint16_t seqnum, uint32_t validity,
+                                        bool listed);
+
+/**
+ * @brief   Account the RSSI and LQI of a frame received from a neighbor
+ *
+ * The neighbor is added if it isn't known, replacing the one heard least
+ * recently if the set is full.
+ *
+ * @param[in] addr Address of the neighbor.
+ * @param[in] rssi RSSI of the frame in dBm, @ref AODVV2_NEIGH_NO_RSSI if
+ *                 not available.
+ * @param[in] lqi  LQI of the frame, @ref AODVV2_NEIGH_NO_LQI if not
+ *                 available.
+ *
+ * @return The neighbor.
+ */
+aodvv2_neigh_t *aodvv2_neigh_lq_sample(const ipv6_addr_t *addr, int16_t rssi,
+                                       uint8_t lqi);
+
+/**
+ * @brief   Account the outcome of a unicast frame sent to a neighbor
+ *
+ * @param[in] addr    Address of the neighbor.
+ * @param[in] success true if the frame was acknowledged.
+ *
+ * @return true if the link to the neighbor just broke, after
+ *         @ref CONFIG_AODVV2_LINK_BREAK_FAILURES consecutive failures.
+ */
+bool aodvv2_neigh_tx_result(const ipv6_addr_t *addr, bool success);
+
+/**
+ * @brief   Is a neighbor blacklisted?
+ *
+ * RREQs received from a blacklisted neighbor are dropped, a route over
+ * the link would not work in the other direction. A neighbor is
+ * blacklisted for @ref CONFIG_AODVV2_MAX_BLACKLIST_TIME after the link to
+ * it breaks, and while its HELLOs don't list us.
+ *
+ * @param[in] addr Address of the neighbor.
+ *
+ * @return true if it's blacklisted.
+ */
+bool aodvv2_neigh_is_blacklisted(const ipv6_addr_t *addr);
+
+/**
+ * @brief   Remove the neighbors not heard within their validity time
+ */
+void aodvv2_neigh_expire(void);
+
+/**
+ * @brief   Did the Neighbor Set change since the last call?
+ *
+ * A change is a neighbor added or lost through HELLOs, or the state of
+ * a link changing.
+ *
+ * @return true if it changed.
+ */
+bool aodvv2_neigh_changed(void);
+
+/**
+ * @brief   Iterate the neighbors to list on our next HELLO
+ *
+ * Only the neighbors something was received from are listed. Stale
+ * neighbors aren't removed while iterating, call aodvv2_neigh_expire()
+ * before.
+ *
+ * @pre @p state != NULL
+ *
+ * @param[in,out] state Iteration state, 0 to get the first neighbor.
+ *
+ * @return The next neighbor, NULL if there are no more.
+ */
+const aodvv2_neigh_t *aodvv2_neigh_hello_next(unsigned *state);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NET_AODVV2_NEIGH_H */
+/** @} */
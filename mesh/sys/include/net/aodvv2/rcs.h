@@ -37,6 +37,21 @@ extern "C" {
 #endif
 /** @} */
 
+/**
+ * @name    Well-known anycast prefix of the gateways
+ *
+ * Routers with an uplink add it to their Router Client Set, so a route
+ * discovery for an address on it is answered by the closest one.
+ * @{
+ */
+#ifndef CONFIG_AODVV2_GATEWAY_PREFIX
+#define CONFIG_AODVV2_GATEWAY_PREFIX "fdff::"
+#endif
+#ifndef CONFIG_AODVV2_GATEWAY_PREFIX_LEN
+#define CONFIG_AODVV2_GATEWAY_PREFIX_LEN (64)
+#endif
+/** @} */
+
 /**
  * @brief   Router Client Set entry
  *
@@ -123,6 +138,47 @@ aodvv2_rcs_entry_t *aodvv2_rcs_matches(const ipv6_addr_t *addr,
  */
 aodvv2_rcs_entry_t *aodvv2_rcs_is_client(const ipv6_addr_t *addr);
 
+/**
+ * @brief   Add the gateway anycast prefix to the Router Client Set
+ *
+ * @param[in] cost Cost associated with the uplink.
+ *
+ * @return NULL if the Set is full or the prefix is already on it.
+ * @return Pointer to the entry in the client set.
+ */
+aodvv2_rcs_entry_t *aodvv2_rcs_gateway_add(uint8_t cost);
+
+/**
+ * @brief   Remove the gateway anycast prefix from the Router Client Set
+ */
+void aodvv2_rcs_gateway_del(void);
+
+/**
+ * @brief   Checks if an address is on the gateway anycast prefix
+ *
+ * Gateways answer for these addresses with SeqNums of their own, so routes
+ * to them are only compared by metric.
+ *
+ * @pre @p addr != NULL
+ *
+ * @param[in] addr The IPv6 address.
+ *
+ * @return true if it's on the prefix.
+ */
+bool aodvv2_rcs_is_gateway(const ipv6_addr_t *addr);
+
+/**
+ * @brief   Copy the RCS entries.
+ *
+ * @pre @p entries != NULL
+ *
+ * @param[out] entries Where to copy the entries.
+ * @param[in]  max     Maximum number of entries on @p entries.
+ *
+ * @return Number of entries copied.
+ */
+unsigned aodvv2_rcs_get_entries(aodvv2_rcs_entry_t *entries, unsigned max);
+
 /**
  * @brief   Print RCS entries.
  *
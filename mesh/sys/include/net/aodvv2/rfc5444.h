@@ -22,10 +22,13 @@
 #ifndef NET_AODVV2_RFC5444_H
 #define NET_AODVV2_RFC5444_H
 
+#include <stdbool.h>
+
 #include "net/aodvv2/seqnum.h"
 #include "net/manet.h"
 #include "net/metric.h"
 
+#include "kernel_defines.h"
 #include "timex.h"
 
 #include "common/netaddr.h"
@@ -38,9 +41,16 @@ extern "C" {
 
 /**
  * @name    RFC5444 thread stack size
+ *
+ * The deepest path is a RREQ decoded by the generic reader: its parse
+ * context and the Local Route built from it, the size of about two
+ * messages, are on the stack when the reader callbacks flush the batch
+ * through the writer and GNRC. The reader and writer frames take about
+ * 1 KiB more than the default stack of a thread.
  */
 #ifndef CONFIG_AODVV2_RFC5444_STACK_SIZE
-#define CONFIG_AODVV2_RFC5444_STACK_SIZE     (2048)
+#define CONFIG_AODVV2_RFC5444_STACK_SIZE \
+    (THREAD_STACKSIZE_DEFAULT + 1024 + (2 * sizeof(aodvv2_message_t)))
 #endif
 
 /**
@@ -57,6 +67,53 @@ extern "C" {
 #define CONFIG_AODVV2_RFC5444_MSG_QUEUE_SIZE (32)
 #endif
 
+/**
+ * @name    Maximum number of messages handled before flushing a batch
+ */
+#ifndef CONFIG_AODVV2_RFC5444_BATCH_SIZE
+#define CONFIG_AODVV2_RFC5444_BATCH_SIZE     (8)
+#endif
+
+/**
+ * @name    Maximum number of outgoing messages waiting for the batch flush
+ */
+#ifndef CONFIG_AODVV2_RFC5444_PENDING_MSGS
+#define CONFIG_AODVV2_RFC5444_PENDING_MSGS   (4)
+#endif
+
+/**
+ * @name    Maximum number of route updates waiting for the batch flush
+ */
+#ifndef CONFIG_AODVV2_RFC5444_PENDING_ROUTES
+#define CONFIG_AODVV2_RFC5444_PENDING_ROUTES (4)
+#endif
+
+/**
+ * @name    Largest received RREQ that is forwarded without re-encoding it
+ */
+#ifndef CONFIG_AODVV2_RFC5444_FORWARD_SIZE
+#define CONFIG_AODVV2_RFC5444_FORWARD_SIZE   (64)
+#endif
+
+/**
+ * @name    Maximum number of TargPrefixes on a RREQ
+ *
+ * A RREQ can look for several TargNodes of the same OrigNode with a single
+ * flood, received RREQs carrying more TargPrefixes are dropped.
+ */
+#ifndef CONFIG_AODVV2_RREQ_MAX_TARGETS
+#define CONFIG_AODVV2_RREQ_MAX_TARGETS       (3)
+#endif
+
+/**
+ * @name    Largest packet carried on a RREQ, IPv6 header included
+ *
+ * Only used with CONFIG_AODVV2_RREQ_PIGGYBACK.
+ */
+#ifndef CONFIG_AODVV2_RREQ_DATA_SIZE
+#define CONFIG_AODVV2_RREQ_DATA_SIZE         (64)
+#endif
+
 /**
  * @name    RFC5444 maximum packet size
  */
@@ -78,7 +135,7 @@ typedef enum {
     RFC5444_MSGTYPE_RREQ = 10,    /**< RREQ message type */
     RFC5444_MSGTYPE_RREP = 11,    /**< RREP message type */
     RFC5444_MSGTYPE_RERR = 12,    /**< RERR message type */
-    RFC5444_MSGTYPE_RREP_ACK = 13 /**< RREP_Ack message type */
+    RFC5444_MSGTYPE_RREP_ACK = 13, /**< RREP_Ack message type */
 } rfc5444_msg_type_t;
 
 /**
@@ -91,6 +148,19 @@ typedef enum {
     RFC5444_MSGTLV_METRIC,
 } rfc5444_tlv_type_t;
 
+/**
+ * @brief   HELLO address TLV with the delivery ratio measured from the
+ *          neighbor, experimental type
+ *
+ * HELLOs are otherwise RFC6130_MSGTYPE_HELLO messages as NHDP sends them.
+ */
+#define RFC5444_ADDRTLV_DELIVERY_RATIO (224)
+
+/**
+ * @brief   RREQ message TLV with a packet for TargNode, experimental type
+ */
+#define RFC5444_MSGTLV_DATA (224)
+
 /**
  * @brief   Data about an OrigNode or TargNode.
  */
@@ -110,10 +180,37 @@ typedef struct {
     routing_metric_t metric_type; /**< Metric type */
     node_data_t orig_node;        /**< OrigNode data */
     node_data_t targ_node;        /**< TargNode data */
+    node_data_t extra_targs[CONFIG_AODVV2_RREQ_MAX_TARGETS - 1]; /**< Further
+                                       TargNodes of a multi-target RREQ, or
+                                       TargRouter clients on a RREP */
+    uint8_t num_extra_targs;      /**< Number of TargNodes on @ref extra_targs */
     ipv6_addr_t seqnortr;         /**< SeqNoRtr */
     timex_t timestamp;            /**< Time at which the message was received */
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK) || defined(DOXYGEN)
+    uint8_t data;                 /**< IPv6 packet carried on a RREQ, index
+                                       from aodvv2_rreq_data_alloc(), 0 if
+                                       none */
+#endif
 } aodvv2_message_t;
 
+/**
+ * @brief   Does a message carry a packet?
+ *
+ * @param[in] msg The message.
+ *
+ * @return true if it does, always false without
+ *         CONFIG_AODVV2_RREQ_PIGGYBACK.
+ */
+static inline bool aodvv2_message_has_data(const aodvv2_message_t *msg)
+{
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    return msg->data != 0;
+#else
+    (void)msg;
+    return false;
+#endif
+}
+
 typedef struct {
     struct rfc5444_writer_target target; /**< RFC5444 writer target */
     ipv6_addr_t target_addr;             /**< Address where the packet will be sent */
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 packets carried on RREQs
+ *
+ * A RREQ carrying a packet refers to an entry of a small pool by index,
+ * so messages stay small when they are queued or copied. The entry
+ * belongs to the message until it has been written, taking one fails
+ * when all of them are in use.
+ *
+ * Only used with CONFIG_AODVV2_RREQ_PIGGYBACK.
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ */
+
+#ifndef NET_AODVV2_RREQ_DATA_H
+#define NET_AODVV2_RREQ_DATA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "net/aodvv2/rfc5444.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of packets carried on RREQs waiting to be sent
+ */
+#ifndef CONFIG_AODVV2_RREQ_DATA_NUMOF
+#define CONFIG_AODVV2_RREQ_DATA_NUMOF (2)
+#endif
+
+/**
+ * @brief   Packet carried on a RREQ
+ */
+typedef struct {
+    uint8_t data[CONFIG_AODVV2_RREQ_DATA_SIZE]; /**< IPv6 packet */
+    uint8_t len;                  /**< Length of @ref data, 0 if free */
+} aodvv2_rreq_data_t;
+
+/**
+ * @brief   Take an entry for a packet
+ *
+ * @param[in] len Length of the packet.
+ *
+ * @return Index of the entry, to be filled through aodvv2_rreq_data_get().
+ * @return 0 if the packet is too large or all entries are in use.
+ */
+uint8_t aodvv2_rreq_data_alloc(size_t len);
+
+/**
+ * @brief   Get an entry
+ *
+ * @param[in] idx Index of the entry.
+ *
+ * @return The entry, NULL if @p idx is 0.
+ */
+aodvv2_rreq_data_t *aodvv2_rreq_data_get(uint8_t idx);
+
+/**
+ * @brief   Give an entry back
+ *
+ * @param[in] idx Index of the entry, nothing is done if it's 0.
+ */
+void aodvv2_rreq_data_free(uint8_t idx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NET_AODVV2_RREQ_DATA_H */
+/** @} */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 adaptive protocol timers
+ *
+ * Route lifetimes (ACTIVE_INTERVAL + MAX_IDLETIME) and MAX_SEQNUM_LIFETIME,
+ * which also is the McMsg retention window, are scaled between
+ * @ref CONFIG_AODVV2_TIMERS_MIN_PERCENT and 100 percent of their Kconfig
+ * values from what the router observes.
+ *
+ * Every @ref CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL the routes broken and the
+ * route discoveries started and completed on the interval are looked at.
+ * A discovery is followed for RREQ_WAIT_TIME: only the first RREP for its
+ * TargNode completes it, and further RREQs for that TargNode meanwhile
+ * belong to it.
+ * An interval with broken routes, or where most route discoveries failed,
+ * halves the distance of the scale to its minimum so stale routes go away
+ * sooner. A quiet interval raises the scale by
+ * @ref CONFIG_AODVV2_TIMERS_STEP_PERCENT, back to the Kconfig values on
+ * static deployments.
+ *
+ * Without CONFIG_AODVV2_ADAPTIVE_TIMERS the Kconfig values are used as is.
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ */
+
+#ifndef NET_AODVV2_TIMERS_H
+#define NET_AODVV2_TIMERS_H
+
+#include <stdint.h>
+
+#include "kernel_defines.h"
+#include "net/aodvv2/conf.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Interval between adaptations in seconds
+ */
+#ifndef CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL
+#define CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL (30)
+#endif
+
+/**
+ * @brief   Lowest scale of the timers, in percent of their Kconfig values
+ */
+#ifndef CONFIG_AODVV2_TIMERS_MIN_PERCENT
+#define CONFIG_AODVV2_TIMERS_MIN_PERCENT (25)
+#endif
+
+/**
+ * @brief   Scale increase after an interval without route breaks, in
+ *          percent of the Kconfig values
+ */
+#ifndef CONFIG_AODVV2_TIMERS_STEP_PERCENT
+#define CONFIG_AODVV2_TIMERS_STEP_PERCENT (10)
+#endif
+
+/**
+ * @brief   Maximum number of route discoveries followed at once
+ *
+ * When all are in use the oldest is replaced.
+ */
+#ifndef CONFIG_AODVV2_TIMERS_DISCOVERIES
+#define CONFIG_AODVV2_TIMERS_DISCOVERIES (4)
+#endif
+
+/**
+ * @brief   State of the adaptive timers
+ */
+typedef struct {
+    uint8_t scale;                 /**< Scale of the timers in percent */
+    uint16_t max_idletime;         /**< MAX_IDLETIME in seconds */
+    uint16_t max_seqnum_lifetime;  /**< MAX_SEQNUM_LIFETIME in seconds */
+    uint16_t breaks;               /**< Routes broken on this interval */
+    uint16_t discoveries;          /**< Route discoveries started on this
+                                        interval */
+    uint16_t discoveries_done;     /**< Route discoveries completed on this
+                                        interval */
+} aodvv2_timers_t;
+
+/**
+ * @brief   Start with the Kconfig values
+ */
+void aodvv2_timers_init(void);
+
+/**
+ * @brief   Tune the timers from the interval that just ended
+ *
+ * @note Call this every @ref CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL.
+ */
+void aodvv2_timers_adapt(void);
+
+/**
+ * @brief   Account routes that broke
+ *
+ * @param[in] num Number of Local Routes that became Broken.
+ */
+void aodvv2_timers_routes_broken(unsigned num);
+
+/**
+ * @brief   Account a route discovery we started
+ *
+ * @pre @p targ != NULL
+ *
+ * @param[in] targ TargNode address of the RREQ.
+ */
+void aodvv2_timers_discovery_started(const ipv6_addr_t *targ);
+
+/**
+ * @brief   Account a RREP we received for one of our route discoveries
+ *
+ * @pre @p targ != NULL
+ *
+ * @param[in] targ    TargNode address of the RREP.
+ * @param[in] pfx_len TargNode prefix length of the RREP.
+ */
+void aodvv2_timers_discovery_done(const ipv6_addr_t *targ, uint8_t pfx_len);
+
+/**
+ * @brief   Lifetime of a new route, ACTIVE_INTERVAL + MAX_IDLETIME
+ *
+ * @return Lifetime in seconds.
+ */
+uint16_t aodvv2_timers_route_lifetime(void);
+
+/**
+ * @brief   Time sequence number information is kept, MAX_SEQNUM_LIFETIME
+ *
+ * Expired Local Routes are removed and McMsgs are forgotten after it.
+ *
+ * @return Lifetime in seconds.
+ */
+uint16_t aodvv2_timers_seqnum_lifetime(void);
+
+/**
+ * @brief   Get the state of the adaptive timers
+ *
+ * @pre @p timers != NULL
+ *
+ * @param[out] timers The state.
+ */
+void aodvv2_timers_get(aodvv2_timers_t *timers);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NET_AODVV2_TIMERS_H */
+/** @} */
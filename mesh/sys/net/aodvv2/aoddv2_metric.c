@@ -21,15 +21,125 @@
  */
 
 #include "net/aodvv2/metric.h"
+#include "net/aodvv2/energy.h"
+#include "net/aodvv2/neigh.h"
 
 #include <assert.h>
 
-uint8_t aodvv2_metric_link_cost(routing_metric_t metric_type)
+#if CONFIG_AODVV2_LQL_RSSI_MIN >= CONFIG_AODVV2_LQL_RSSI_MAX
+#error "CONFIG_AODVV2_LQL_RSSI_MIN must be lower than CONFIG_AODVV2_LQL_RSSI_MAX"
+#endif
+
+/**
+ * @brief   ETX of the link to a neighbor, 1 / (df * dr)
+ *
+ * The delivery ratio the neighbor didn't report yet is taken to be the same
+ * as the one we measured.
+ */
+static uint8_t _etx_link_cost(const ipv6_addr_t *neighbor)
+{
+    const aodvv2_neigh_t *neigh = NULL;
+    if (neighbor != NULL) {
+        neigh = aodvv2_neigh_get(neighbor);
+    }
+
+    if (neigh == NULL || neigh->rev_ratio == 0) {
+        return AODVV2_METRIC_ETX_LINK_UNKNOWN;
+    }
+
+    uint32_t df = neigh->fwd_ratio ? neigh->fwd_ratio : neigh->rev_ratio;
+    uint32_t dr = neigh->rev_ratio;
+    uint32_t cost = (AODVV2_METRIC_ETX_UNIT * AODVV2_NEIGH_RATIO_MAX *
+                     AODVV2_NEIGH_RATIO_MAX) / (df * dr);
+
+    return cost > AODVV2_METRIC_ETX_LINK_MAX ? AODVV2_METRIC_ETX_LINK_MAX
+                                             : cost;
+}
+
+/**
+ * @brief   Quality of the link to a neighbor, from 0 (lowest) to 255
+ *
+ * The lower of the qualities given by the averages of RSSI and LQI, so a
+ * link is only taken as good if both agree.
+ */
+static int _lq_quality(const aodvv2_neigh_t *neigh)
+{
+    const int32_t rssi_min = CONFIG_AODVV2_LQL_RSSI_MIN *
+                             (1 << AODVV2_NEIGH_EWMA_FRAC);
+    const int32_t rssi_max = CONFIG_AODVV2_LQL_RSSI_MAX *
+                             (1 << AODVV2_NEIGH_EWMA_FRAC);
+    int quality = -1;
+
+    if (neigh->has_rssi) {
+        int32_t rssi = neigh->rssi_avg;
+        rssi = rssi < rssi_min ? rssi_min : rssi;
+        rssi = rssi > rssi_max ? rssi_max : rssi;
+        quality = ((rssi - rssi_min) * UINT8_MAX) / (rssi_max - rssi_min);
+    }
+
+    if (neigh->has_lqi) {
+        int lqi = neigh->lqi_avg >> AODVV2_NEIGH_EWMA_FRAC;
+        if (quality < 0 || lqi < quality) {
+            quality = lqi;
+        }
+    }
+
+    return quality;
+}
+
+/**
+ * @brief   Link Quality Level of the link to a neighbor
+ */
+static uint8_t _lql_link_cost(const ipv6_addr_t *neighbor)
+{
+    const aodvv2_neigh_t *neigh = NULL;
+    if (neighbor != NULL) {
+        neigh = aodvv2_neigh_get(neighbor);
+    }
+
+    int quality = neigh != NULL ? _lq_quality(neigh) : -1;
+    if (quality < 0) {
+        return AODVV2_METRIC_LQL_LINK_UNKNOWN;
+    }
+
+    const unsigned levels = AODVV2_METRIC_LQL_LINK_WORST -
+                            AODVV2_METRIC_LQL_LINK_BEST;
+    return AODVV2_METRIC_LQL_LINK_WORST -
+           (((quality * levels) + (UINT8_MAX / 2)) / UINT8_MAX);
+}
+
+/**
+ * @brief   Node Energy cost of relaying through this node
+ */
+static uint8_t _energy_link_cost(void)
+{
+    uint8_t soc = aodvv2_energy_soc();
+    if (soc == AODVV2_ENERGY_SOC_UNKNOWN || aodvv2_energy_is_charging()) {
+        return AODVV2_METRIC_ENERGY_LINK_MIN;
+    }
+
+    unsigned drained = 100 - soc;
+    return AODVV2_METRIC_ENERGY_LINK_MIN +
+           (((AODVV2_METRIC_ENERGY_LINK_MAX - AODVV2_METRIC_ENERGY_LINK_MIN) *
+             drained * drained) / (100 * 100));
+}
+
+uint8_t aodvv2_metric_link_cost(routing_metric_t metric_type,
+                                const ipv6_addr_t *neighbor)
 {
     switch (metric_type) {
         case METRIC_HOP_COUNT:
             return AODVV2_METRIC_HOP_COUNT_COST;
 
+        case METRIC_LINK_ETX:
+            return _etx_link_cost(neighbor);
+
+        case METRIC_LINK_QUALITY_LEVEL:
+            return _lql_link_cost(neighbor);
+
+        case METRIC_NODE_ENERGY:
+            return _energy_link_cost();
+
         default:
             return 0;
     }
@@ -40,6 +150,9 @@ bool aodvv2_metric_loop_free(routing_metric_t metric_type, uint8_t a,
 {
     switch (metric_type) {
         case METRIC_HOP_COUNT:
+        case METRIC_LINK_ETX:
+        case METRIC_LINK_QUALITY_LEVEL:
+        case METRIC_NODE_ENERGY:
             return a <= b;
 
         /* Undefined for other metric types */
@@ -54,6 +167,15 @@ uint8_t aodvv2_metric_max(routing_metric_t metric_type)
         case METRIC_HOP_COUNT:
             return CONFIG_METRIC_HOP_COUNT_AODVV2_MAX;
 
+        case METRIC_LINK_ETX:
+            return CONFIG_METRIC_LINK_ETX_AODVV2_MAX;
+
+        case METRIC_LINK_QUALITY_LEVEL:
+            return CONFIG_METRIC_LINK_QUALITY_LEVEL_AODVV2_MAX;
+
+        case METRIC_NODE_ENERGY:
+            return CONFIG_METRIC_NODE_ENERGY_AODVV2_MAX;
+
         default:
             return 0;
     }
@@ -61,13 +183,21 @@ uint8_t aodvv2_metric_max(routing_metric_t metric_type)
     return 0;
 }
 
-void aodvv2_metric_update(routing_metric_t metric_type, uint8_t *metric)
+void aodvv2_metric_update(routing_metric_t metric_type, uint8_t link_cost,
+                          uint8_t *metric)
 {
     assert(metric != NULL);
 
     switch (metric_type) {
         case METRIC_HOP_COUNT:
-            *metric = (*metric) + 1;
+        case METRIC_LINK_ETX:
+        case METRIC_LINK_QUALITY_LEVEL:
+        case METRIC_NODE_ENERGY:
+            {
+                unsigned max = aodvv2_metric_max(metric_type);
+                unsigned value = (*metric) + link_cost;
+                *metric = value > max ? max : value;
+            }
             break;
 
         default:
@@ -22,24 +22,50 @@
 
 #include "net/aodvv2.h"
 #include "net/aodvv2/rfc5444.h"
+#include "net/aodvv2/energy.h"
 #include "net/aodvv2/lrs.h"
 #include "net/aodvv2/mcmsg.h"
 #include "net/aodvv2/metric.h"
+#include "net/aodvv2/neigh.h"
 #include "net/aodvv2/rcs.h"
+#include "net/aodvv2/rreq_data.h"
 #include "net/aodvv2/seqnum.h"
+#include "net/aodvv2/timers.h"
 
 #include "net/gnrc/ipv6.h"
 #include "net/gnrc/udp.h"
 #include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/ipv6/nib/ft.h"
 
 #include "mutex.h"
+#include "random.h"
+#include "thread.h"
+#include "xtimer.h"
 
+#include "rfc5444/rfc5444_pool.h"
+
+#include "aodvv2_link.h"
 #include "aodvv2_reader.h"
 #include "aodvv2_writer.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
+#if !IS_ACTIVE(CONFIG_AODVV2_RFC5444_WRITER_HEAP) && \
+    (CONFIG_RFC5444_WRITER_POOL_ADDRS < CONFIG_AODVV2_RREQ_MAX_TARGETS + 1)
+#error "CONFIG_RFC5444_WRITER_POOL_ADDRS can't hold a multi-target RREQ"
+#endif
+
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK) && \
+    (CONFIG_AODVV2_RFC5444_PACKET_SIZE < CONFIG_AODVV2_RREQ_DATA_SIZE + 64)
+#error "CONFIG_AODVV2_RFC5444_PACKET_SIZE can't hold a RREQ carrying data"
+#endif
+
+#if !IS_ACTIVE(CONFIG_AODVV2_RFC5444_WRITER_HEAP) && \
+    (CONFIG_RFC5444_WRITER_POOL_MSGS < 3)
+#error "CONFIG_RFC5444_WRITER_POOL_MSGS can't hold the RREQ, RREP and HELLO"
+#endif
+
 #if ENABLE_DEBUG == 1
 #include "rfc5444/rfc5444_print.h"
 #endif
@@ -68,9 +94,15 @@ static gnrc_netreg_entry_t netreg = GNRC_NETREG_ENTRY_INIT_PID(GNRC_NETREG_DEMUX
 
 /**
  * @brief   The RFC5444 packet reader context
+ *
+ * @note    Doesn't need a lock, the AODVv2 parse state is kept per packet.
  */
 static struct rfc5444_reader _reader;
-static mutex_t _reader_lock;
+
+/**
+ * @brief   Entries of the RFC5444 reader, unless it uses the heap
+ */
+static struct rfc5444_reader_pool _reader_pool;
 
 /**
  * @brief   The RFC5444 packet writer context
@@ -82,6 +114,169 @@ static uint8_t _writer_msg_addrtlvs[CONFIG_AODVV2_RFC5444_ADDR_TLVS_SIZE];
 static uint8_t _writer_pkt_buffer[CONFIG_AODVV2_RFC5444_PACKET_SIZE];
 static mutex_t _writer_lock;
 
+/**
+ * @brief   Outgoing message waiting for the end of the batch
+ */
+typedef struct {
+    uint16_t type;          /**< AODVV2_MSG_TYPE_SEND_RREQ or _RREP */
+    aodvv2_msg_t msg;       /**< Message and next hop */
+    uint16_t fwd_len;       /**< Length of @ref fwd, 0 if not forwarding */
+    uint16_t fwd_metric;    /**< Offset of the OrigNode metric on @ref fwd */
+    uint8_t fwd[CONFIG_AODVV2_RFC5444_FORWARD_SIZE]; /**< Received RREQ */
+} pending_msg_t;
+
+/**
+ * @brief   NIB forwarding table update waiting for the end of the batch
+ */
+typedef struct {
+    ipv6_addr_t dst;        /**< Route destination */
+    ipv6_addr_t next_hop;   /**< Next hop */
+    uint16_t ltime;         /**< Route lifetime */
+    uint8_t pfx_len;        /**< Destination prefix length */
+} pending_route_t;
+
+/**
+ * @brief   Pending outgoing messages, only accessed by the AODVv2 thread
+ */
+static pending_msg_t _pending_msgs[CONFIG_AODVV2_RFC5444_PENDING_MSGS];
+static unsigned _pending_msgs_num;
+
+/**
+ * @brief   Pending route updates, only accessed by the AODVv2 thread
+ */
+static pending_route_t _pending_routes[CONFIG_AODVV2_RFC5444_PENDING_ROUTES];
+static unsigned _pending_routes_num;
+
+/**
+ * @brief   RREQ of the route discoveries started on the current window, only
+ *          accessed by the AODVv2 thread
+ */
+static aodvv2_message_t _rreq_batch;
+static bool _rreq_batch_open;
+static xtimer_t _rreq_batch_timer;
+static msg_t _rreq_batch_msg = { .type = AODVV2_MSG_TYPE_RREQ_BATCH };
+
+/**
+ * @brief   HELLOs, always sent when the ETX metric is used
+ */
+#define AODVV2_HELLO_ACTIVE \
+    (IS_ACTIVE(CONFIG_AODVV2_HELLO) || \
+     CONFIG_AODVV2_DEFAULT_METRIC == METRIC_LINK_ETX)
+
+static xtimer_t _hello_timer;
+static msg_t _hello_msg = { .type = AODVV2_MSG_TYPE_HELLO };
+static uint16_t _hello_seqnum;
+static uint32_t _hello_interval;
+
+/**
+ * @brief   Fuel gauge readings, only taken when there's a fuel gauge driver
+ */
+static xtimer_t _energy_timer;
+static msg_t _energy_msg = { .type = AODVV2_MSG_TYPE_ENERGY_POLL };
+
+/**
+ * @brief   Adaptation of the protocol timers
+ */
+static xtimer_t _timers_timer;
+static msg_t _timers_msg = { .type = AODVV2_MSG_TYPE_TIMERS_ADAPT };
+
+/**
+ * @brief   Repair of a broken route we were forwarding packets on
+ */
+typedef struct {
+    ipv6_addr_t dst;        /**< Destination of the route */
+    uint32_t deadline;      /**< Time the repair fails, in microseconds */
+    bool used;              /**< Is this entry used? */
+} repair_t;
+
+/**
+ * @brief   Route repairs in progress, only accessed by the AODVv2 thread
+ *
+ * Each one has packets buffered, so there can't be more than buffered
+ * destinations.
+ */
+static repair_t _repairs[CONFIG_AODVV2_BUFFER_MAX_DESTINATIONS];
+static xtimer_t _repair_timer;
+static msg_t _repair_msg = { .type = AODVV2_MSG_TYPE_REPAIR_TIMEOUT };
+
+/**
+ * @brief   Destination whose route repair was asked for by the IPv6 thread
+ */
+typedef struct {
+    ipv6_addr_t dst;        /**< Destination of the route */
+    bool used;              /**< Is this entry used? */
+} repair_req_t;
+
+/**
+ * @brief   Repairs not yet started by the AODVv2 thread,
+ *          @ref AODVV2_MSG_TYPE_LOCAL_REPAIR carries the index of one
+ */
+static repair_req_t _repair_reqs[CONFIG_AODVV2_BUFFER_MAX_DESTINATIONS];
+static mutex_t _repair_reqs_lock = MUTEX_INIT;
+
+/**
+ * @brief   Event loop histograms
+ */
+static aodvv2_batch_stats_t _stats;
+static mutex_t _stats_lock = MUTEX_INIT;
+
+static int _find_route(const ipv6_addr_t *orig_addr,
+                       const ipv6_addr_t *target_addr,
+                       const gnrc_pktsnip_t *data);
+
+/*
+ * Buffer a packet we forward on a Broken route, the AODVv2 thread decides if
+ * the route to dst can be repaired
+ */
+static void _repair_request(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt)
+{
+    ipv6_addr_t addr = *dst;
+    aodvv2_local_route_t *rt_entry =
+        aodvv2_lrs_get_entry(&addr, CONFIG_AODVV2_DEFAULT_METRIC);
+
+    /* Destinations we never had a route to aren't looked for */
+    if (rt_entry == NULL || rt_entry->state != ROUTE_STATE_BROKEN) {
+        DEBUG_PUTS("aodvv2: no broken route to repair");
+        return;
+    }
+
+    if (aodvv2_buffer_pkt_add(dst, pkt) < 0) {
+        DEBUG("aodvv2: couldn't buffer packet!\n");
+        return;
+    }
+
+    /* The packet waits on the buffer until it expires if no repair can
+     * be asked for */
+    int idx = -1;
+    mutex_lock(&_repair_reqs_lock);
+    for (unsigned i = 0; i < ARRAY_SIZE(_repair_reqs); i++) {
+        if (!_repair_reqs[i].used) {
+            idx = i;
+        }
+        else if (ipv6_addr_equal(&_repair_reqs[i].dst, dst)) {
+            idx = -1;
+            break;
+        }
+    }
+    if (idx >= 0) {
+        _repair_reqs[idx].dst = *dst;
+        _repair_reqs[idx].used = true;
+    }
+    mutex_unlock(&_repair_reqs_lock);
+
+    if (idx < 0) {
+        return;
+    }
+
+    msg_t msg = { .type = AODVV2_MSG_TYPE_LOCAL_REPAIR, .content.value = idx };
+    if (msg_send(&msg, _pid) < 1) {
+        DEBUG("aodvv2: couldn't send message.\n");
+        mutex_lock(&_repair_reqs_lock);
+        _repair_reqs[idx].used = false;
+        mutex_unlock(&_repair_reqs_lock);
+    }
+}
+
 static void _route_info(unsigned type, const ipv6_addr_t *ctx_addr,
                         const void *ctx)
 {
@@ -97,7 +292,16 @@ static void _route_info(unsigned type, const ipv6_addr_t *ctx_addr,
                 ipv6_hdr_t *ipv6_hdr = gnrc_ipv6_get_header(pkt);
 
                 if (aodvv2_rcs_is_client(&ipv6_hdr->src) != NULL) {
-                    if (aodvv2_buffer_pkt_add(ctx_addr, pkt) == 0) {
+                    gnrc_pktsnip_t *ip = gnrc_pktsnip_search_type(
+                        pkt, GNRC_NETTYPE_IPV6);
+
+                    /* Small packets travel on the RREQ instead */
+                    if (IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK) &&
+                        gnrc_pkt_len(ip) <= CONFIG_AODVV2_RREQ_DATA_SIZE &&
+                        _find_route(&ipv6_hdr->src, ctx_addr, ip) == 0) {
+                        DEBUG("aodvv2: finding route, packet on RREQ\n");
+                    }
+                    else if (aodvv2_buffer_pkt_add(ctx_addr, pkt) == 0) {
                         DEBUG("aodvv2: finding route\n");
                         aodvv2_find_route(&ipv6_hdr->src, ctx_addr);
                     }
@@ -105,6 +309,10 @@ static void _route_info(unsigned type, const ipv6_addr_t *ctx_addr,
                         DEBUG("aodvv2: couldn't buffer packet!\n");
                     }
                 }
+                else if (IS_ACTIVE(CONFIG_AODVV2_LOCAL_REPAIR)) {
+                    DEBUG("aodvv2: src is not our client, repairing route\n");
+                    _repair_request(ctx_addr, pkt);
+                }
                 else {
                     DEBUG("aodvv2: src is not our client!\n");
                 }
@@ -125,36 +333,6 @@ static void _route_info(unsigned type, const ipv6_addr_t *ctx_addr,
     }
 }
 
-static void _send_rreq(aodvv2_message_t *message, ipv6_addr_t *next_hop)
-{
-    assert(message != NULL);
-    assert(next_hop != NULL);
-
-    /* Make sure no other thread is using the writer right now */
-    mutex_lock(&_writer_lock);
-    _writer_context.target_addr = *next_hop;
-
-    aodvv2_writer_send_rreq(&_writer, message);
-
-    rfc5444_writer_flush(&_writer, &_writer_context.target, false);
-    mutex_unlock(&_writer_lock);
-}
-
-static void _send_rrep(aodvv2_message_t *message, ipv6_addr_t *next_hop)
-{
-    assert(message != NULL);
-    assert(next_hop != NULL);
-
-    /* Make sure no other thread is using the writer right now */
-    mutex_lock(&_writer_lock);
-    _writer_context.target_addr = *next_hop;
-
-    aodvv2_writer_send_rrep(&_writer, message);
-
-    rfc5444_writer_flush(&_writer, &_writer_context.target, false);
-    mutex_unlock(&_writer_lock);
-}
-
 static void _send_packet(struct rfc5444_writer *writer,
                          struct rfc5444_writer_target *iface, void *buffer,
                          size_t length)
@@ -224,6 +402,527 @@ static void _send_packet(struct rfc5444_writer *writer,
     }
 }
 
+static void _flush_routes(void)
+{
+    for (unsigned i = 0; i < _pending_routes_num; i++) {
+        pending_route_t *route = &_pending_routes[i];
+
+        gnrc_ipv6_nib_ft_del(&route->dst, route->pfx_len);
+
+        DEBUG_PUTS("aodvv2: adding route to NIB FT");
+        if (gnrc_ipv6_nib_ft_add(&route->dst, route->pfx_len,
+                                 &route->next_hop, _netif->pid,
+                                 route->ltime) < 0) {
+            DEBUG_PUTS("aodvv2: couldn't add route");
+        }
+    }
+
+    _pending_routes_num = 0;
+}
+
+static void _flush_msgs(void)
+{
+    if (_pending_msgs_num == 0) {
+        return;
+    }
+
+    /* Make sure no other thread is using the writer right now */
+    mutex_lock(&_writer_lock);
+
+    /* Messages going to the same next hop share the RFC5444 packets */
+    for (unsigned i = 0; i < _pending_msgs_num; i++) {
+        ipv6_addr_t *next_hop = &_pending_msgs[i].msg.next_hop;
+
+        /* Already sent along with a previous next hop */
+        if (_pending_msgs[i].type == 0) {
+            continue;
+        }
+
+        _writer_context.target_addr = *next_hop;
+
+        for (unsigned j = i; j < _pending_msgs_num; j++) {
+            pending_msg_t *pending = &_pending_msgs[j];
+
+            if (pending->type == 0 ||
+                !ipv6_addr_equal(&pending->msg.next_hop, next_hop)) {
+                continue;
+            }
+
+            if (pending->type == AODVV2_MSG_TYPE_SEND_RREQ &&
+                pending->fwd_len > 0) {
+                /* Re-encode if the copy can't be used */
+                if (aodvv2_writer_forward_rreq(&_writer, &pending->msg.pkt,
+                                               pending->fwd, pending->fwd_len,
+                                               pending->fwd_metric) < 0) {
+                    aodvv2_writer_send_rreq(&_writer, &pending->msg.pkt);
+                }
+            }
+            else if (pending->type == AODVV2_MSG_TYPE_SEND_RREQ) {
+                aodvv2_writer_send_rreq(&_writer, &pending->msg.pkt);
+            }
+            else {
+                aodvv2_writer_send_rrep(&_writer, &pending->msg.pkt);
+            }
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+            aodvv2_rreq_data_free(pending->msg.pkt.data);
+#endif
+            pending->type = 0;
+        }
+
+        rfc5444_writer_flush(&_writer, &_writer_context.target, false);
+    }
+
+    mutex_unlock(&_writer_lock);
+
+    _pending_msgs_num = 0;
+}
+
+/**
+ * @brief   Apply the route updates and send the messages of the batch
+ *
+ * Routes go first so the messages and buffered packets sent afterwards
+ * find them on the NIB.
+ */
+static void _flush(void)
+{
+    _flush_routes();
+    _flush_msgs();
+}
+
+static pending_msg_t *_pending_msg_add(uint16_t type,
+                                       const aodvv2_message_t *pkt,
+                                       const ipv6_addr_t *next_hop)
+{
+    if (_pending_msgs_num == ARRAY_SIZE(_pending_msgs)) {
+        DEBUG_PUTS("aodvv2: pending messages full, flushing");
+        _flush();
+    }
+
+    pending_msg_t *pending = &_pending_msgs[_pending_msgs_num++];
+    pending->type = type;
+    pending->msg.pkt = *pkt;
+    pending->msg.next_hop = *next_hop;
+    pending->fwd_len = 0;
+
+    return pending;
+}
+
+static void _rreq_batch_close(void)
+{
+    if (!_rreq_batch_open) {
+        return;
+    }
+
+    xtimer_remove(&_rreq_batch_timer);
+    _rreq_batch_open = false;
+
+    DEBUG("aodvv2: sending RREQ for %u TargNodes\n",
+          _rreq_batch.num_extra_targs + 1U);
+    _pending_msg_add(AODVV2_MSG_TYPE_SEND_RREQ, &_rreq_batch,
+                     &ipv6_addr_all_manet_routers_link_local);
+}
+
+static bool _rreq_batch_has_targ(const ipv6_addr_t *addr)
+{
+    if (ipv6_addr_equal(&_rreq_batch.targ_node.addr, addr)) {
+        return true;
+    }
+
+    for (unsigned i = 0; i < _rreq_batch.num_extra_targs; i++) {
+        if (ipv6_addr_equal(&_rreq_batch.extra_targs[i].addr, addr)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   Add a RREQ we originate to the current window
+ *
+ * RREQs of the same OrigNode started on the window are sent as a single
+ * multi-target RREQ, carrying the OrigSeqNum of the first one.
+ */
+static void _rreq_batch_add(const aodvv2_message_t *pkt)
+{
+    if (_rreq_batch_open &&
+        (!ipv6_addr_equal(&_rreq_batch.orig_node.addr, &pkt->orig_node.addr) ||
+         _rreq_batch.orig_node.pfx_len != pkt->orig_node.pfx_len ||
+         _rreq_batch.metric_type != pkt->metric_type ||
+         _rreq_batch.msg_hop_limit != pkt->msg_hop_limit)) {
+        _rreq_batch_close();
+    }
+
+    if (!_rreq_batch_open) {
+        _rreq_batch = *pkt;
+        _rreq_batch_open = true;
+        xtimer_set_msg(&_rreq_batch_timer, CONFIG_AODVV2_RREQ_BATCH_MS * US_PER_MS,
+                       &_rreq_batch_msg, _pid);
+        return;
+    }
+
+    if (_rreq_batch_has_targ(&pkt->targ_node.addr)) {
+        DEBUG_PUTS("aodvv2: TargNode already on RREQ");
+        return;
+    }
+
+    _rreq_batch.extra_targs[_rreq_batch.num_extra_targs++] = pkt->targ_node;
+
+    if (_rreq_batch.num_extra_targs == ARRAY_SIZE(_rreq_batch.extra_targs)) {
+        _rreq_batch_close();
+    }
+}
+
+/**
+ * @brief   Queue a message produced by the AODVv2 thread or received from
+ *          another thread
+ */
+static void _queue_msg(uint16_t type, const aodvv2_message_t *pkt,
+                       const ipv6_addr_t *next_hop)
+{
+    /* Only RREQs we originate go through aodvv2_send_rreq(), received ones
+     * are forwarded with aodvv2_forward_rreq() */
+    if (CONFIG_AODVV2_RREQ_BATCH_MS > 0 && type == AODVV2_MSG_TYPE_SEND_RREQ &&
+        pkt->num_extra_targs == 0 && !aodvv2_message_has_data(pkt) &&
+        ipv6_addr_equal(next_hop, &ipv6_addr_all_manet_routers_link_local)) {
+        _rreq_batch_add(pkt);
+        return;
+    }
+
+    _pending_msg_add(type, pkt, next_hop);
+}
+
+/**
+ * @brief   Send a HELLO listing our neighbors
+ *
+ * The interval doubles while the Neighbor Set stays the same, and goes back
+ * to the minimum as soon as it changes. A HELLO that doesn't fit in the
+ * writer pool is split in several messages with the same SeqNum.
+ */
+static void _hello_send(void)
+{
+    aodvv2_neigh_expire();
+    if (aodvv2_neigh_changed() || _hello_interval == 0) {
+        _hello_interval = CONFIG_AODVV2_HELLO_INTERVAL_MIN * MS_PER_SEC;
+    }
+    else {
+        _hello_interval *= 2;
+        if (_hello_interval > CONFIG_AODVV2_HELLO_INTERVAL_MAX * MS_PER_SEC) {
+            _hello_interval = CONFIG_AODVV2_HELLO_INTERVAL_MAX * MS_PER_SEC;
+        }
+    }
+
+    unsigned per_msg = IS_ACTIVE(CONFIG_AODVV2_RFC5444_WRITER_HEAP)
+                       ? CONFIG_AODVV2_NEIGH_ENTRIES
+                       : CONFIG_RFC5444_WRITER_POOL_ADDRS;
+    uint16_t seqnum = _hello_seqnum++;
+
+    mutex_lock(&_writer_lock);
+
+    _writer_context.target_addr = ipv6_addr_all_manet_routers_link_local;
+    /* The Neighbor Set is listed as is, a HELLO is sent even without
+     * neighbors */
+    unsigned state = 0;
+    unsigned next;
+    do {
+        if (aodvv2_writer_send_hello(&_writer, seqnum, _hello_interval,
+                                     _hello_interval *
+                                     AODVV2_NEIGH_HELLO_VALIDITY,
+                                     &state, per_msg) < 0) {
+            break;
+        }
+        next = state;
+    } while (aodvv2_neigh_hello_next(&next) != NULL);
+    rfc5444_writer_flush(&_writer, &_writer_context.target, false);
+
+    mutex_unlock(&_writer_lock);
+
+    /* Jitter keeps the HELLOs of neighbors from colliding */
+    uint32_t interval = _hello_interval * US_PER_MS;
+    xtimer_set_msg(&_hello_timer,
+                   random_uint32_range(interval - (interval / 4), interval),
+                   &_hello_msg, _pid);
+}
+
+static void _energy_poll(void)
+{
+    aodvv2_energy_update();
+    xtimer_set_msg(&_energy_timer,
+                   CONFIG_AODVV2_ENERGY_POLL_INTERVAL * US_PER_SEC,
+                   &_energy_msg, _pid);
+}
+
+static void _timers_adapt(void)
+{
+    aodvv2_timers_adapt();
+    xtimer_set_msg(&_timers_timer,
+                   CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL * US_PER_SEC,
+                   &_timers_msg, _pid);
+}
+
+/*
+ * Switch the routes through neighbor that have an alternate next hop, the
+ * NIB FT entries are replaced when flushing. Routes are switched one at
+ * a time, straight from the Local Route Set.
+ */
+static void _failover(const ipv6_addr_t *neighbor)
+{
+    aodvv2_local_route_t *route;
+    timex_t now;
+
+    xtimer_now_timex(&now);
+
+    /* Switched routes no longer go through neighbor, repeat until none */
+    while ((route = aodvv2_lrs_failover(neighbor)) != NULL) {
+        DEBUG_PUTS("aodvv2: link broken, route switched");
+
+        /* Keep the lifetime the route has left */
+        uint32_t ltime = 1;
+        if (timex_cmp(route->expiration_time, now) > 0) {
+            ltime = timex_sub(route->expiration_time, now).seconds;
+        }
+        if (ltime == 0) {
+            ltime = 1;
+        }
+        else if (ltime > UINT16_MAX) {
+            ltime = UINT16_MAX;
+        }
+
+        aodvv2_route_update(&route->addr, route->pfx_len, &route->next_hop,
+                            ltime);
+    }
+}
+
+/**
+ * @brief   Stop using the routes through a neighbor the link to is broken
+ *
+ * The Local Routes become Broken, a new route discovery can replace them,
+ * and their NIB entries are removed so the next packet starts it.
+ */
+static void _link_broken(const ipv6_addr_t *neighbor)
+{
+    if (IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)) {
+        _failover(neighbor);
+    }
+
+    unsigned num = aodvv2_lrs_set_broken(neighbor);
+    DEBUG("aodvv2: link broken, %u routes broken\n", num);
+    aodvv2_timers_routes_broken(num);
+
+    /* Routes still pending could go through the neighbor */
+    _flush_routes();
+
+    gnrc_ipv6_nib_ft_t fte;
+    gnrc_ipv6_nib_ft_t last = { .dst_len = 0 };
+
+    /* Removing an entry invalidates the iteration, start over each time */
+    while (1) {
+        void *state = NULL;
+        bool found = false;
+
+        while (gnrc_ipv6_nib_ft_iter(neighbor, _netif->pid, &state, &fte)) {
+            /* Only the routes AODVv2 added, not the default route */
+            if (fte.dst_len > 0) {
+                found = true;
+                break;
+            }
+        }
+
+        /* Also stop if the NIB didn't let go of the last one */
+        if (!found || (fte.dst_len == last.dst_len &&
+                       ipv6_addr_equal(&fte.dst, &last.dst))) {
+            break;
+        }
+
+        DEBUG_PUTS("aodvv2: removing route from NIB FT");
+        gnrc_ipv6_nib_ft_del(&fte.dst, fte.dst_len);
+        last = fte;
+    }
+}
+
+static void _link_tx(void)
+{
+    ipv6_addr_t neighbor;
+    bool success;
+
+    while (aodvv2_link_event_get(&neighbor, &success)) {
+        if (aodvv2_neigh_tx_result(&neighbor, success)) {
+            _link_broken(&neighbor);
+        }
+    }
+}
+
+static void _repair_timer_update(uint32_t now)
+{
+    repair_t *next = NULL;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_repairs); i++) {
+        if (_repairs[i].used &&
+            (next == NULL ||
+             (int32_t)(_repairs[i].deadline - next->deadline) < 0)) {
+            next = &_repairs[i];
+        }
+    }
+
+    xtimer_remove(&_repair_timer);
+    if (next != NULL) {
+        int32_t offset = next->deadline - now;
+        xtimer_set_msg(&_repair_timer, offset > 0 ? (uint32_t)offset : 0,
+                       &_repair_msg, _pid);
+    }
+}
+
+/*
+ * Get a routable address of ours to originate route repairs with
+ */
+static bool _repair_orig(ipv6_addr_t *addr)
+{
+    ipv6_addr_t addrs[CONFIG_GNRC_NETIF_IPV6_ADDRS_NUMOF];
+    int res = gnrc_netif_ipv6_addrs_get(_netif, addrs, sizeof(addrs));
+
+    for (int i = 0; i < (res / (int)sizeof(ipv6_addr_t)); i++) {
+        if (!ipv6_addr_is_link_local(&addrs[i])) {
+            *addr = addrs[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief   Repair the route to a destination we forward packets to
+ *
+ * Only a Broken Local Route is repaired, with a RREQ that doesn't go
+ * further than @ref CONFIG_AODVV2_LOCAL_REPAIR_HOP_LIMIT hops. Its RREP
+ * dispatches the buffered packets, if none comes back within
+ * @ref CONFIG_AODVV2_RREQ_WAIT_TIME they are dropped.
+ */
+static void _repair_start(ipv6_addr_t *dst)
+{
+    repair_t *repair = NULL;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_repairs); i++) {
+        if (!_repairs[i].used) {
+            repair = &_repairs[i];
+        }
+        else if (ipv6_addr_equal(&_repairs[i].dst, dst)) {
+            DEBUG_PUTS("aodvv2: route repair already in progress");
+            return;
+        }
+    }
+
+    aodvv2_local_route_t *rt_entry =
+        aodvv2_lrs_get_entry(dst, CONFIG_AODVV2_DEFAULT_METRIC);
+
+    /* Repaired by a RREP of this batch, not yet on the NIB */
+    if (rt_entry != NULL && (rt_entry->state == ROUTE_STATE_ACTIVE ||
+                             rt_entry->state == ROUTE_STATE_IDLE)) {
+        aodvv2_buffer_dispatch(dst);
+        return;
+    }
+
+    aodvv2_message_t pkt = { 0 };
+
+    if (rt_entry == NULL || rt_entry->state != ROUTE_STATE_BROKEN ||
+        repair == NULL || !_repair_orig(&pkt.orig_node.addr)) {
+        DEBUG_PUTS("aodvv2: can't repair route");
+        aodvv2_buffer_drop(dst);
+        return;
+    }
+
+    DEBUG_PUTS("aodvv2: repairing route");
+    pkt.msg_hop_limit = CONFIG_AODVV2_LOCAL_REPAIR_HOP_LIMIT;
+    pkt.metric_type = rt_entry->metric_type;
+
+    pkt.orig_node.pfx_len = 128;
+    pkt.orig_node.metric = 0;
+    pkt.orig_node.seqnum = aodvv2_seqnum_get();
+    aodvv2_seqnum_inc();
+
+    pkt.targ_node.addr = *dst;
+    pkt.targ_node.pfx_len = 128;
+
+    /* Add RREQ to mcmsg */
+    aodvv2_mcmsg_process(&pkt);
+    aodvv2_timers_discovery_started(dst);
+    _queue_msg(AODVV2_MSG_TYPE_SEND_RREQ, &pkt,
+               &ipv6_addr_all_manet_routers_link_local);
+
+    uint32_t now = xtimer_now_usec();
+    repair->used = true;
+    repair->dst = *dst;
+    repair->deadline = now + (CONFIG_AODVV2_RREQ_WAIT_TIME * US_PER_SEC);
+    _repair_timer_update(now);
+}
+
+static void _repair_timeout(void)
+{
+    uint32_t now = xtimer_now_usec();
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_repairs); i++) {
+        repair_t *repair = &_repairs[i];
+        if (!repair->used || (int32_t)(now - repair->deadline) < 0) {
+            continue;
+        }
+
+        repair->used = false;
+
+        aodvv2_local_route_t *rt_entry =
+            aodvv2_lrs_get_entry(&repair->dst, CONFIG_AODVV2_DEFAULT_METRIC);
+        if (rt_entry == NULL || rt_entry->state == ROUTE_STATE_BROKEN) {
+            /* Following packets are dropped right away */
+            DEBUG_PUTS("aodvv2: route repair failed");
+            aodvv2_lrs_delete_entry(&repair->dst, CONFIG_AODVV2_DEFAULT_METRIC);
+            aodvv2_buffer_drop(&repair->dst);
+        }
+    }
+
+    _repair_timer_update(now);
+}
+
+static unsigned _hist_bucket(unsigned value)
+{
+    unsigned bucket = 0;
+
+    while (value > 1 && bucket < (AODVV2_BATCH_HIST_BUCKETS - 1)) {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static void _stats_record(unsigned queue_depth, unsigned batch_size)
+{
+    mutex_lock(&_stats_lock);
+    _stats.queue_depth[_hist_bucket(queue_depth)]++;
+    _stats.batch_size[_hist_bucket(batch_size)]++;
+    mutex_unlock(&_stats_lock);
+}
+
+/*
+ * Account the RSSI and LQI GNRC reports for a received packet to the
+ * neighbor that sent it
+ */
+static void _lq_sample(gnrc_pktsnip_t *pkt, const ipv6_addr_t *sender)
+{
+    gnrc_pktsnip_t *snip = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_NETIF);
+    if (snip == NULL) {
+        DEBUG_PUTS("aodvv2: no netif header, can't sample link quality");
+        return;
+    }
+
+    gnrc_netif_hdr_t *hdr = snip->data;
+    int16_t rssi = hdr->rssi == GNRC_NETIF_HDR_NO_RSSI ? AODVV2_NEIGH_NO_RSSI
+                                                       : hdr->rssi;
+    uint8_t lqi = hdr->lqi == GNRC_NETIF_HDR_NO_LQI ? AODVV2_NEIGH_NO_LQI
+                                                   : hdr->lqi;
+
+    DEBUG("aodvv2: link quality sample, rssi = %d, lqi = %u\n", rssi, lqi);
+    aodvv2_neigh_lq_sample(sender, rssi, lqi);
+}
+
 static void _receive(gnrc_pktsnip_t *pkt)
 {
     assert(pkt != NULL && pkt->data != NULL && pkt->size > 0);
@@ -247,16 +946,101 @@ static void _receive(gnrc_pktsnip_t *pkt)
     assert(ipv6_hdr != NULL);
     memcpy(&sender, &ipv6_hdr->src, sizeof(ipv6_addr_t));
 
-    mutex_lock(&_reader_lock);
-    aodvv2_rfc5444_handle_packet_prepare(&sender);
-    if (rfc5444_reader_handle_packet(&_reader, pkt->data, pkt->size) != RFC5444_OKAY) {
+    /* Before reading, the link cost of this packet takes its sample */
+    if (CONFIG_AODVV2_DEFAULT_METRIC == METRIC_LINK_QUALITY_LEVEL) {
+        _lq_sample(pkt, &sender);
+    }
+
+    if (aodvv2_reader_handle_packet(&_reader, &sender, pkt->data,
+                                    pkt->size) != RFC5444_OKAY) {
         DEBUG("aodvv2: couldn't handle packet!\n");
     }
-    mutex_unlock(&_reader_lock);
 
     gnrc_pktbuf_release(pkt);
 }
 
+static void _handle_msg(msg_t *msg, msg_t *reply)
+{
+    switch (msg->type) {
+        case AODVV2_MSG_TYPE_SEND_RREQ:
+        case AODVV2_MSG_TYPE_SEND_RREP:
+            DEBUG("AODVV2_MSG_TYPE_SEND_%s\n",
+                  msg->type == AODVV2_MSG_TYPE_SEND_RREQ ? "RREQ" : "RREP");
+            {
+                aodvv2_msg_t *m = msg->content.ptr;
+                _queue_msg(msg->type, &m->pkt, &m->next_hop);
+                free(m);
+            }
+            break;
+
+        case AODVV2_MSG_TYPE_RREQ_BATCH:
+            DEBUG("AODVV2_MSG_TYPE_RREQ_BATCH\n");
+            _rreq_batch_close();
+            break;
+
+        case AODVV2_MSG_TYPE_HELLO:
+            DEBUG("AODVV2_MSG_TYPE_HELLO\n");
+            _hello_send();
+            break;
+
+        case AODVV2_MSG_TYPE_ENERGY_POLL:
+            DEBUG("AODVV2_MSG_TYPE_ENERGY_POLL\n");
+            _energy_poll();
+            break;
+
+        case AODVV2_MSG_TYPE_LINK_TX:
+            DEBUG("AODVV2_MSG_TYPE_LINK_TX\n");
+            _link_tx();
+            break;
+
+        case AODVV2_MSG_TYPE_LOCAL_REPAIR:
+            DEBUG("AODVV2_MSG_TYPE_LOCAL_REPAIR\n");
+            {
+                repair_req_t *req = &_repair_reqs[msg->content.value];
+                ipv6_addr_t dst;
+
+                mutex_lock(&_repair_reqs_lock);
+                dst = req->dst;
+                req->used = false;
+                mutex_unlock(&_repair_reqs_lock);
+
+                _repair_start(&dst);
+            }
+            break;
+
+        case AODVV2_MSG_TYPE_REPAIR_TIMEOUT:
+            DEBUG("AODVV2_MSG_TYPE_REPAIR_TIMEOUT\n");
+            _repair_timeout();
+            break;
+
+        case AODVV2_MSG_TYPE_TIMERS_ADAPT:
+            DEBUG("AODVV2_MSG_TYPE_TIMERS_ADAPT\n");
+            _timers_adapt();
+            break;
+
+        case AODVV2_MSG_TYPE_BUFFER_TICK:
+            DEBUG("AODVV2_MSG_TYPE_BUFFER_TICK\n");
+            /* Buffered packets need the routes found on this batch */
+            _flush_routes();
+            aodvv2_buffer_tick();
+            break;
+
+        case GNRC_NETAPI_MSG_TYPE_RCV:
+            DEBUG("GNRC_NETAPI_MSG_TYPE_RCV\n");
+            _receive((gnrc_pktsnip_t *)msg->content.ptr);
+            break;
+
+        case GNRC_NETAPI_MSG_TYPE_GET:
+        case GNRC_NETAPI_MSG_TYPE_SET:
+            msg_reply(msg, reply);
+            break;
+
+        default:
+            DEBUG("aodvv2: received unidentified message\n");
+            break;
+    }
+}
+
 static void *_event_loop(void *arg)
 {
     (void)arg;
@@ -273,43 +1057,18 @@ static void *_event_loop(void *arg)
     while (1) {
         msg_receive(&msg);
 
-        switch (msg.type) {
-            case AODVV2_MSG_TYPE_SEND_RREQ:
-                DEBUG("AODVV2_MSG_TYPE_SEND_RREQ\n");
-                {
-                    aodvv2_msg_t m;
-                    memcpy(&m, (aodvv2_msg_t *)msg.content.ptr, sizeof(m));
-                    free(msg.content.ptr);
-
-                    _send_rreq(&m.pkt, &m.next_hop);
-                }
-                break;
-
-            case AODVV2_MSG_TYPE_SEND_RREP:
-                DEBUG("AODVV2_MSG_TYPE_SEND_RREP\n");
-                {
-                    aodvv2_msg_t m;
-                    memcpy(&m, (aodvv2_msg_t *)msg.content.ptr, sizeof(m));
-                    free(msg.content.ptr);
-
-                    _send_rrep(&m.pkt, &m.next_hop);
-                }
-                break;
-
-            case GNRC_NETAPI_MSG_TYPE_RCV:
-                DEBUG("GNRC_NETAPI_MSG_TYPE_RCV\n");
-                _receive((gnrc_pktsnip_t *)msg.content.ptr);
-                break;
-
-            case GNRC_NETAPI_MSG_TYPE_GET:
-            case GNRC_NETAPI_MSG_TYPE_SET:
-                msg_reply(&msg, &reply);
-                break;
-
-            default:
-                DEBUG("aodvv2: received unidentified message\n");
-                break;
-        }
+        /* Drain the queue, route updates and outgoing messages produced by
+         * the whole batch are flushed together at the end */
+        unsigned queue_depth = msg_avail() + 1;
+        unsigned batch_size = 0;
+        do {
+            _handle_msg(&msg, &reply);
+            batch_size++;
+        } while (batch_size < CONFIG_AODVV2_RFC5444_BATCH_SIZE &&
+                 msg_try_receive(&msg) == 1);
+
+        _flush();
+        _stats_record(queue_depth, batch_size);
     }
 
     /* Never reached */
@@ -326,7 +1085,6 @@ int aodvv2_init(gnrc_netif_t *netif)
     }
 
     mutex_init(&_writer_lock);
-    mutex_init(&_reader_lock);
 
     /* Start RFC5444 thread */
     _pid = thread_create(_stack, sizeof(_stack), CONFIG_AODVV2_RFC5444_PRIO,
@@ -343,25 +1101,33 @@ int aodvv2_init(gnrc_netif_t *netif)
 
     /* Initialize AODVv2 internal structures */
     aodvv2_seqnum_init();
+    aodvv2_timers_init();
     aodvv2_lrs_init();
     aodvv2_rcs_init();
     aodvv2_mcmsg_init();
-    aodvv2_buffer_init();
-
-    /* Register netreg */
-    gnrc_netreg_entry_init_pid(&netreg, UDP_MANET_PORT, _pid);
-    gnrc_netreg_register(GNRC_NETTYPE_UDP, &netreg);
+    aodvv2_neigh_init();
+    aodvv2_energy_init();
+    aodvv2_buffer_init(_pid);
 
-    /* Initialize RFC5444 reader */
-    mutex_lock(&_reader_lock);
+    if (IS_ACTIVE(CONFIG_AODVV2_GATEWAY) && aodvv2_rcs_gateway_add(1) == NULL) {
+        DEBUG_PUTS("aodvv2: couldn't add gateway prefix");
+    }
 
-    /* Initialize reader */
+    /* Initialize RFC5444 reader, before registering on netreg so no packet
+     * is handled by a partially initialized reader */
     rfc5444_reader_init(&_reader);
 
+    /* Keep the receive path off the heap */
+    if (!IS_ACTIVE(CONFIG_AODVV2_RFC5444_READER_HEAP)) {
+        rfc5444_reader_pool_attach(&_reader, &_reader_pool);
+    }
+
     /* Register AODVv2 messages reader */
-    aodvv2_reader_init(&_reader, _netif->pid);
+    aodvv2_reader_init(&_reader);
 
-    mutex_unlock(&_reader_lock);
+    /* Register netreg */
+    gnrc_netreg_entry_init_pid(&netreg, UDP_MANET_PORT, _pid);
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &netreg);
 
     /* Initialize RFC5444 writer */
     mutex_lock(&_writer_lock);
@@ -378,6 +1144,11 @@ int aodvv2_init(gnrc_netif_t *netif)
     /* Set function to send binary packet content */
     _writer_context.target.sendPacket = _send_packet;
 
+    /* Keep message generation off the heap */
+    if (!IS_ACTIVE(CONFIG_AODVV2_RFC5444_WRITER_HEAP)) {
+        rfc5444_writer_pool_attach(&_writer);
+    }
+
     /* Initialize writer */
     rfc5444_writer_init(&_writer);
 
@@ -393,71 +1164,245 @@ int aodvv2_init(gnrc_netif_t *netif)
      */
     _netif->ipv6.route_info_cb = _route_info;
 
+    /* Link costs and symmetry are learned from the HELLOs of the
+     * neighbors */
+    if (AODVV2_HELLO_ACTIVE) {
+        aodvv2_neigh_set_lost_cb(_link_broken);
+        msg_send(&_hello_msg, _pid);
+    }
+
+    if (IS_USED(MODULE_BQ27441)) {
+        msg_send(&_energy_msg, _pid);
+    }
+
+    if (IS_ACTIVE(CONFIG_AODVV2_ADAPTIVE_TIMERS)) {
+        xtimer_set_msg(&_timers_timer,
+                       CONFIG_AODVV2_TIMERS_ADAPT_INTERVAL * US_PER_SEC,
+                       &_timers_msg, _pid);
+    }
+
+    if (IS_ACTIVE(CONFIG_AODVV2_LINK_BREAK_DETECTION)) {
+        aodvv2_link_init(_netif, _pid);
+    }
+
     return _pid;
 }
 
-int aodvv2_send_rreq(aodvv2_message_t *pkt,
-                     ipv6_addr_t *next_hop)
+static int _send(uint16_t type, aodvv2_message_t *pkt, ipv6_addr_t *next_hop)
 {
+    /* Messages generated by the AODVv2 thread itself join the current
+     * batch */
+    if (thread_getpid() == _pid) {
+        _queue_msg(type, pkt, next_hop);
+        return 0;
+    }
+
     aodvv2_msg_t *msg = malloc(sizeof(aodvv2_msg_t));
     if (msg == NULL) {
         DEBUG("aodvv2: out of memory!\n");
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+        aodvv2_rreq_data_free(pkt->data);
+#endif
         return -1;
     }
 
     /* Set destination address */
     memcpy(&msg->next_hop, next_hop, sizeof(ipv6_addr_t));
 
-    /* Copy RREQ packet */
+    /* Copy packet */
     memcpy(&msg->pkt, pkt, sizeof(aodvv2_message_t));
 
     /* Prepare and send IPC message */
     msg_t ipc_msg;
     ipc_msg.content.ptr = msg;
-    ipc_msg.type = AODVV2_MSG_TYPE_SEND_RREQ;
+    ipc_msg.type = type;
 
     if (msg_send(&ipc_msg, _pid) < 1) {
-        DEBUG("aodvv2: couldn't send RREQ.\n");
+        DEBUG("aodvv2: couldn't send message.\n");
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+        aodvv2_rreq_data_free(pkt->data);
+#endif
+        free(msg);
         return -1;
     }
 
     return 0;
 }
 
+int aodvv2_send_rreq(aodvv2_message_t *pkt,
+                     ipv6_addr_t *next_hop)
+{
+    return _send(AODVV2_MSG_TYPE_SEND_RREQ, pkt, next_hop);
+}
+
 int aodvv2_send_rrep(aodvv2_message_t *pkt,
                      ipv6_addr_t *next_hop)
 {
-    aodvv2_msg_t *msg = malloc(sizeof(aodvv2_msg_t));
-    if (msg == NULL) {
-        DEBUG("aodvv2: out of memory!\n");
+    return _send(AODVV2_MSG_TYPE_SEND_RREP, pkt, next_hop);
+}
+
+void aodvv2_forward_rreq(aodvv2_message_t *pkt, const ipv6_addr_t *next_hop,
+                         const uint8_t *msg, size_t len,
+                         const uint8_t *metric)
+{
+    assert(pkt != NULL && next_hop != NULL && msg != NULL);
+    assert(thread_getpid() == _pid);
+
+    pending_msg_t *pending =
+        _pending_msg_add(AODVV2_MSG_TYPE_SEND_RREQ, pkt, next_hop);
+
+    /* Without a copy the RREQ is encoded again when flushing */
+    if (metric == NULL || len > sizeof(pending->fwd) ||
+        metric < msg || metric >= msg + len) {
+        return;
+    }
+
+    memcpy(pending->fwd, msg, len);
+    pending->fwd_len = len;
+    pending->fwd_metric = metric - msg;
+
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    /* The copy carries the packet already */
+    aodvv2_rreq_data_free(pending->msg.pkt.data);
+    pending->msg.pkt.data = 0;
+#endif
+}
+
+void aodvv2_route_update(const ipv6_addr_t *dst, uint8_t pfx_len,
+                         const ipv6_addr_t *next_hop, uint16_t ltime)
+{
+    assert(dst != NULL && next_hop != NULL);
+    assert(thread_getpid() == _pid);
+
+    /* A later update of the same route replaces the previous one */
+    pending_route_t *route = NULL;
+    for (unsigned i = 0; i < _pending_routes_num; i++) {
+        if (_pending_routes[i].pfx_len == pfx_len &&
+            ipv6_addr_equal(&_pending_routes[i].dst, dst)) {
+            route = &_pending_routes[i];
+            break;
+        }
+    }
+
+    if (route == NULL) {
+        if (_pending_routes_num == ARRAY_SIZE(_pending_routes)) {
+            DEBUG_PUTS("aodvv2: pending routes full, flushing");
+            _flush_routes();
+        }
+        route = &_pending_routes[_pending_routes_num++];
+    }
+
+    route->dst = *dst;
+    route->pfx_len = pfx_len;
+    route->next_hop = *next_hop;
+    route->ltime = ltime;
+}
+
+bool aodvv2_is_local_addr(const ipv6_addr_t *addr)
+{
+    assert(addr != NULL);
+
+    return gnrc_netif_ipv6_addr_idx(_netif, addr) >= 0;
+}
+
+void aodvv2_batch_stats_get(aodvv2_batch_stats_t *stats)
+{
+    assert(stats != NULL);
+
+    mutex_lock(&_stats_lock);
+    *stats = _stats;
+    mutex_unlock(&_stats_lock);
+}
+
+void aodvv2_reader_pool_stats_get(struct rfc5444_reader_pool_stats *stats)
+{
+    assert(stats != NULL);
+
+    rfc5444_reader_pool_get_stats(&_reader_pool, stats);
+}
+
+int aodvv2_rreq_data_deliver(const uint8_t *data, size_t len,
+                             const node_data_t *targ)
+{
+    assert(data != NULL && targ != NULL);
+
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    /* The TLV value isn't aligned, the header is copied into the pktbuf */
+    ipv6_hdr_t hdr;
+
+    if (len < sizeof(ipv6_hdr_t)) {
+        DEBUG_PUTS("aodvv2: data on RREQ isn't an IPv6 packet");
         return -1;
     }
 
-    /* Set destination address */
-    memcpy(&msg->next_hop, next_hop, sizeof(ipv6_addr_t));
+    memcpy(&hdr, data, sizeof(hdr));
+    if (!ipv6_hdr_is(&hdr)) {
+        DEBUG_PUTS("aodvv2: data on RREQ isn't an IPv6 packet");
+        return -1;
+    }
 
-    /* Copy RREQ packet */
-    memcpy(&msg->pkt, pkt, sizeof(aodvv2_message_t));
+    if (ipv6_addr_match_prefix(&hdr.dst, &targ->addr) < targ->pfx_len) {
+        DEBUG_PUTS("aodvv2: data on RREQ isn't for TargNode");
+        return -1;
+    }
 
-    /* Prepare and send IPC message */
-    msg_t ipc_msg;
-    ipc_msg.content.ptr = msg;
-    ipc_msg.type = AODVV2_MSG_TYPE_SEND_RREP;
+    /* The originator took the packet before the IPv6 thread filled in the
+     * header and upper layer checksum, it's sent as if it was new */
+    size_t payload_len = len - sizeof(ipv6_hdr_t);
+    gnrc_pktsnip_t *payload = NULL;
+    if (payload_len > 0) {
+        payload = gnrc_pktbuf_add(NULL, &data[sizeof(ipv6_hdr_t)],
+                                  payload_len,
+                                  gnrc_nettype_from_protnum(hdr.nh));
+        if (payload == NULL) {
+            DEBUG_PUTS("aodvv2: couldn't allocate payload");
+            return -1;
+        }
+    }
 
-    if (msg_send(&ipc_msg, _pid) < 1) {
-        DEBUG("aodvv2: couldn't send RREQ.\n");
+    gnrc_pktsnip_t *ip = gnrc_pktbuf_add(payload, &hdr, sizeof(ipv6_hdr_t),
+                                         GNRC_NETTYPE_IPV6);
+    if (ip == NULL) {
+        DEBUG_PUTS("aodvv2: couldn't allocate IPv6 header");
+        if (payload != NULL) {
+            gnrc_pktbuf_release(payload);
+        }
+        return -1;
+    }
+
+    DEBUG_PUTS("aodvv2: delivering packet carried on RREQ");
+    if (gnrc_netapi_dispatch_send(GNRC_NETTYPE_IPV6,
+                                  GNRC_NETREG_DEMUX_CTX_ALL, ip) < 1) {
+        DEBUG_PUTS("aodvv2: unable to locate IPv6 thread");
+        gnrc_pktbuf_release(ip);
         return -1;
     }
 
     return 0;
+#else
+    (void)len;
+    return -1;
+#endif
 }
 
 int aodvv2_find_route(const ipv6_addr_t *orig_addr,
                       const ipv6_addr_t *target_addr)
+{
+    return _find_route(orig_addr, target_addr, NULL);
+}
+
+/**
+ * @brief   Start a route discovery, carrying @p data on the RREQ
+ *
+ * @param[in] data IPv6 header snip of a packet to carry, NULL for none.
+ */
+static int _find_route(const ipv6_addr_t *orig_addr,
+                       const ipv6_addr_t *target_addr,
+                       const gnrc_pktsnip_t *data)
 {
     assert(orig_addr != NULL && target_addr != NULL);
 
-    aodvv2_message_t pkt;
+    aodvv2_message_t pkt = { 0 };
 
     /* Set metric information */
     pkt.msg_hop_limit = aodvv2_metric_max(METRIC_HOP_COUNT);
@@ -474,6 +1419,25 @@ int aodvv2_find_route(const ipv6_addr_t *orig_addr,
         return -1;
     }
 
+    /* Copy the packet, the IPv6 header and whatever follows it */
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    if (data != NULL) {
+        pkt.data = aodvv2_rreq_data_alloc(gnrc_pkt_len(data));
+        if (pkt.data == 0) {
+            DEBUG_PUTS("aodvv2: packet doesn't fit on RREQ");
+            return -1;
+        }
+
+        uint8_t *ptr = aodvv2_rreq_data_get(pkt.data)->data;
+        for (; data != NULL; data = data->next) {
+            memcpy(ptr, data->data, data->size);
+            ptr += data->size;
+        }
+    }
+#else
+    (void)data;
+#endif
+
     pkt.orig_node.metric = 0;
     pkt.orig_node.seqnum = aodvv2_seqnum_get();
     aodvv2_seqnum_inc();
@@ -486,6 +1450,7 @@ int aodvv2_find_route(const ipv6_addr_t *orig_addr,
 
     /* Add RREQ to mcmsg */
     aodvv2_mcmsg_process(&pkt);
+    aodvv2_timers_discovery_started(target_addr);
 
     return aodvv2_send_rreq(&pkt, &ipv6_addr_all_manet_routers_link_local);
 }
@@ -13,84 +13,468 @@
  * @file
  * @brief       AODVv2 packet buffering
  *
+ * Packets waiting for a route are kept on per-destination FIFO queues. The
+ * buffer is bounded by number of packets, by a share of the packet buffer
+ * (in bytes) and by the age of each packet. When any of the bounds is hit the
+ * oldest packet (head) is dropped. When all queues are in use, a new
+ * destination takes the queue packets were least recently added to, whose
+ * packets are dropped. Packets that time out are answered with an ICMPv6
+ * Destination Unreachable message.
+ *
+ * Once a route is found the queue is drained one packet per
+ * @ref CONFIG_AODVV2_BUFFER_DISPATCH_INTERVAL_MS so a burst of buffered
+ * packets doesn't swamp the new path.
+ *
  * @author      Locha Mesh developers <contact@locha.io>
  * @}
  */
 
 #include <stdbool.h>
 
+#include "mutex.h"
+#include "xtimer.h"
+
 #include "net/aodvv2.h"
 #include "net/gnrc/pktbuf.h"
 #include "net/gnrc/ipv6.h"
+#include "net/gnrc/icmpv6/error.h"
+#include "net/icmpv6.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
-#define CONFIG_AODVV2_MAX_BUFFERED_PACKETS (10)
+/**
+ * @brief   Maximum number of bytes held on the buffer
+ *
+ * A fixed share of the size of the packet buffer, it doesn't follow how much
+ * of the packet buffer is actually in use. Packets can still fail to be
+ * allocated elsewhere while the buffer is below it.
+ */
+#define AODVV2_BUFFER_MAX_BYTES \
+    ((CONFIG_GNRC_PKTBUF_SIZE * CONFIG_AODVV2_BUFFER_PKTBUF_SHARE) / 100)
 
-typedef struct {
+/**
+ * @brief   Maximum age of a buffered packet in microseconds
+ */
+#define AODVV2_BUFFER_PKT_LIFETIME_US \
+    ((uint32_t)CONFIG_AODVV2_BUFFER_PKT_LIFETIME * US_PER_SEC)
+
+/**
+ * @brief   Time between consecutive packets dispatched in microseconds
+ */
+#define AODVV2_BUFFER_DISPATCH_INTERVAL_US \
+    ((uint32_t)CONFIG_AODVV2_BUFFER_DISPATCH_INTERVAL_MS * US_PER_MS)
+
+typedef struct buffered_pkt {
     bool used;
     gnrc_pktsnip_t *pkt;
-    ipv6_addr_t dst;
+    size_t size;                /**< Packet size in bytes */
+    uint32_t timestamp;         /**< Time when the packet was buffered */
+    struct buffered_pkt *next;  /**< Next packet on the queue */
 } buffered_pkt_t;
 
+typedef struct {
+    bool used;
+    bool dispatch;              /**< A route exists, drain the queue */
+    ipv6_addr_t dst;
+    buffered_pkt_t *head;
+    buffered_pkt_t *tail;
+    unsigned count;
+} buffer_queue_t;
+
 static buffered_pkt_t _buffered_pkts[CONFIG_AODVV2_MAX_BUFFERED_PACKETS];
+static buffer_queue_t _queues[CONFIG_AODVV2_BUFFER_MAX_DESTINATIONS];
+static size_t _bytes;
+static mutex_t _lock = MUTEX_INIT;
+
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+static xtimer_t _timer;
+static msg_t _timer_msg = { .type = AODVV2_MSG_TYPE_BUFFER_TICK };
+static bool _timer_set;
 
-static void _pkt_del(unsigned i)
+static buffer_queue_t *_queue_get(const ipv6_addr_t *dst)
 {
-    buffered_pkt_t *entry = &_buffered_pkts[i];
-    if (entry->used) {
-        entry->used = false;
-        entry->pkt = NULL;
-        entry->dst = ipv6_addr_unspecified;
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+        if (queue->used && ipv6_addr_equal(&queue->dst, dst)) {
+            return queue;
+        }
     }
+
+    return NULL;
 }
 
-void aodvv2_buffer_init(void)
+static buffer_queue_t *_queue_add(const ipv6_addr_t *dst)
 {
-    memset(_buffered_pkts, 0, sizeof(_buffered_pkts));
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+        if (!queue->used) {
+            memset(queue, 0, sizeof(buffer_queue_t));
+            queue->used = true;
+            memcpy(&queue->dst, dst, sizeof(ipv6_addr_t));
+            return queue;
+        }
+    }
+
+    return NULL;
 }
 
-int aodvv2_buffer_pkt_add(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt)
+static bool _queue_available(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        if (!_queues[i].used) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _pkt_available(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_buffered_pkts); i++) {
+        if (!_buffered_pkts[i].used) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static buffered_pkt_t *_pkt_alloc(void)
 {
     for (unsigned i = 0; i < ARRAY_SIZE(_buffered_pkts); i++) {
         buffered_pkt_t *entry = &_buffered_pkts[i];
-        /* Find free spot */
         if (!entry->used) {
+            memset(entry, 0, sizeof(buffered_pkt_t));
             entry->used = true;
-            entry->pkt = pkt;
-            memcpy(&entry->dst, dst, sizeof(ipv6_addr_t));
+            return entry;
+        }
+    }
 
-            /* Increase reference count for this packet as we'll l store it
-             * until we find a route to send it (or not, and release the
-             * packet) */
-            gnrc_pktbuf_hold(entry->pkt, 1);
+    return NULL;
+}
+
+/**
+ * @brief   Remove the packet at the head of @p queue
+ *
+ * The queue is released once it's empty.
+ *
+ * @return  The packet, the caller owns the reference held by the buffer.
+ */
+static gnrc_pktsnip_t *_queue_pop(buffer_queue_t *queue)
+{
+    buffered_pkt_t *entry = queue->head;
+    gnrc_pktsnip_t *pkt = entry->pkt;
+
+    queue->head = entry->next;
+    if (queue->head == NULL) {
+        queue->tail = NULL;
+    }
+    queue->count--;
+    _bytes -= entry->size;
+
+    entry->used = false;
+    entry->pkt = NULL;
+    entry->next = NULL;
+
+    if (queue->count == 0) {
+        queue->used = false;
+        queue->dispatch = false;
+        queue->dst = ipv6_addr_unspecified;
+    }
+
+    return pkt;
+}
+
+/**
+ * @brief   Find the queue holding the oldest packet
+ *
+ * @param[in] now          Current time in microseconds.
+ * @param[in] waiting_only Only look at queues still waiting for a route.
+ */
+static buffer_queue_t *_queue_oldest(uint32_t now, bool waiting_only)
+{
+    buffer_queue_t *oldest = NULL;
+    uint32_t oldest_age = 0;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+        if (!queue->used || queue->head == NULL ||
+            (waiting_only && queue->dispatch)) {
+            continue;
+        }
+
+        uint32_t age = now - queue->head->timestamp;
+        if (oldest == NULL || age > oldest_age) {
+            oldest = queue;
+            oldest_age = age;
+        }
+    }
+
+    return oldest;
+}
+
+/**
+ * @brief   Find the queue packets were least recently added to
+ *
+ * Queues still waiting for a route are preferred over the ones being
+ * drained.
+ *
+ * @param[in] now Current time in microseconds.
+ */
+static buffer_queue_t *_queue_lru(uint32_t now)
+{
+    buffer_queue_t *lru = NULL;
+    uint32_t lru_age = 0;
 
-            return 0;
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+        if (!queue->used || queue->tail == NULL) {
+            continue;
+        }
+
+        uint32_t age = now - queue->tail->timestamp;
+        if (lru == NULL || (lru->dispatch && !queue->dispatch) ||
+            (lru->dispatch == queue->dispatch && age > lru_age)) {
+            lru = queue;
+            lru_age = age;
         }
     }
 
-    /* List of buffered packets is _full_ :/ */
-    return -1;
+    return lru;
+}
+
+static void _head_drop(buffer_queue_t *queue)
+{
+    DEBUG_PUTS("aodvv2: buffer full, dropping oldest packet");
+    gnrc_pktbuf_release(_queue_pop(queue));
+}
+
+/**
+ * @brief   Drop packets older than @ref CONFIG_AODVV2_BUFFER_PKT_LIFETIME
+ *
+ * Each expired packet is answered with an ICMPv6 Destination Unreachable
+ * (Address unreachable) message, as route discovery failed for it.
+ */
+static void _expire(uint32_t now)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+
+        /* Queues being drained have a route, their packets only wait for
+         * their turn to be sent */
+        while (queue->used && !queue->dispatch &&
+               (now - queue->head->timestamp) >= AODVV2_BUFFER_PKT_LIFETIME_US) {
+            DEBUG_PUTS("aodvv2: buffered packet timed out");
+            gnrc_pktsnip_t *pkt = _queue_pop(queue);
+            gnrc_icmpv6_error_dst_unr_send(ICMPV6_ERROR_DST_UNR_ADDR, pkt);
+            gnrc_pktbuf_release(pkt);
+        }
+    }
+}
+
+/**
+ * @brief   Schedule the next buffer tick
+ *
+ * While a queue is being drained the tick runs every dispatch interval,
+ * otherwise it fires when the oldest packet waiting for a route expires.
+ */
+static void _timer_update(uint32_t now)
+{
+    bool dispatch = false;
+    buffer_queue_t *oldest = _queue_oldest(now, true);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        if (_queues[i].used && _queues[i].dispatch) {
+            dispatch = true;
+            break;
+        }
+    }
+
+    if (_timer_set) {
+        xtimer_remove(&_timer);
+        _timer_set = false;
+    }
+
+    if ((oldest == NULL && !dispatch) || _pid == KERNEL_PID_UNDEF) {
+        return;
+    }
+
+    uint32_t offset = AODVV2_BUFFER_PKT_LIFETIME_US;
+    if (oldest != NULL) {
+        uint32_t age = now - oldest->head->timestamp;
+        if (age < offset) {
+            offset -= age;
+        }
+        else {
+            offset = 0;
+        }
+    }
+
+    if (dispatch && offset > AODVV2_BUFFER_DISPATCH_INTERVAL_US) {
+        offset = AODVV2_BUFFER_DISPATCH_INTERVAL_US;
+    }
+
+    xtimer_set_msg(&_timer, offset, &_timer_msg, _pid);
+    _timer_set = true;
+}
+
+void aodvv2_buffer_init(kernel_pid_t pid)
+{
+    mutex_lock(&_lock);
+    if (_timer_set) {
+        xtimer_remove(&_timer);
+        _timer_set = false;
+    }
+    memset(_buffered_pkts, 0, sizeof(_buffered_pkts));
+    memset(_queues, 0, sizeof(_queues));
+    _bytes = 0;
+    _pid = pid;
+    mutex_unlock(&_lock);
+}
+
+int aodvv2_buffer_pkt_add(const ipv6_addr_t *dst, gnrc_pktsnip_t *pkt)
+{
+    assert(dst != NULL && pkt != NULL);
+
+    size_t size = gnrc_pkt_len(pkt);
+    if (size > AODVV2_BUFFER_MAX_BYTES) {
+        DEBUG_PUTS("aodvv2: packet too big to be buffered");
+        return -1;
+    }
+
+    mutex_lock(&_lock);
+
+    uint32_t now = xtimer_now_usec();
+
+    /* Make room for the packet before buffering it, stale packets go first */
+    _expire(now);
+
+    buffer_queue_t *queue = _queue_get(dst);
+    if (queue == NULL && !_queue_available()) {
+        /* The queue is released with its last packet */
+        DEBUG_PUTS("aodvv2: no free destination queue, evicting one");
+        buffer_queue_t *lru = _queue_lru(now);
+        while (lru->used) {
+            _head_drop(lru);
+        }
+    }
+
+    /* A single destination can't hold more than its share of packets */
+    if (queue != NULL &&
+        queue->count >= CONFIG_AODVV2_BUFFER_MAX_PER_DESTINATION) {
+        _head_drop(queue);
+    }
+
+    /* Global limits are enforced by dropping the oldest buffered packets */
+    while (_bytes + size > AODVV2_BUFFER_MAX_BYTES || !_pkt_available()) {
+        _head_drop(_queue_oldest(now, false));
+    }
+
+    /* The queue might have been released when dropping packets */
+    queue = _queue_get(dst);
+    if (queue == NULL) {
+        queue = _queue_add(dst);
+    }
+    assert(queue != NULL);
+
+    buffered_pkt_t *entry = _pkt_alloc();
+    assert(entry != NULL);
+
+    entry->pkt = pkt;
+    entry->size = size;
+    entry->timestamp = now;
+
+    if (queue->tail == NULL) {
+        queue->head = entry;
+    }
+    else {
+        queue->tail->next = entry;
+    }
+    queue->tail = entry;
+    queue->count++;
+    _bytes += size;
+
+    /* Increase reference count for this packet as we'll store it until we
+     * find a route to send it (or not, and release the packet) */
+    gnrc_pktbuf_hold(pkt, 1);
+
+    _timer_update(now);
+    mutex_unlock(&_lock);
+
+    return 0;
 }
 
 void aodvv2_buffer_dispatch(const ipv6_addr_t *targ_addr)
 {
     assert(targ_addr != NULL);
 
-    for (unsigned i = 0; i < ARRAY_SIZE(_buffered_pkts); i++) {
-        buffered_pkt_t *entry = &_buffered_pkts[i];
+    mutex_lock(&_lock);
+
+    buffer_queue_t *queue = _queue_get(targ_addr);
+    if (queue == NULL || queue->dispatch) {
+        mutex_unlock(&_lock);
+        return;
+    }
 
-        if (ipv6_addr_equal(&entry->dst, targ_addr)) {
-            int res = gnrc_netapi_dispatch_send(GNRC_NETTYPE_IPV6,
-                                                GNRC_NETREG_DEMUX_CTX_ALL,
-                                                entry->pkt);
+    /* Packets are sent from the buffer tick, start right away */
+    queue->dispatch = true;
+    if (_timer_set) {
+        xtimer_remove(&_timer);
+        _timer_set = false;
+    }
+    if (_pid != KERNEL_PID_UNDEF) {
+        xtimer_set_msg(&_timer, 0, &_timer_msg, _pid);
+        _timer_set = true;
+    }
 
-            if (res < 1) {
-                DEBUG("aodvv2: couldn't dispatch packet!\n");
-            }
-            _pkt_del(i);
-        }
+    mutex_unlock(&_lock);
+}
+
+void aodvv2_buffer_drop(const ipv6_addr_t *dst)
+{
+    assert(dst != NULL);
+
+    mutex_lock(&_lock);
+
+    buffer_queue_t *queue = _queue_get(dst);
+    while (queue != NULL && queue->used) {
+        DEBUG_PUTS("aodvv2: no route for buffered packet");
+        gnrc_pktsnip_t *pkt = _queue_pop(queue);
+        gnrc_icmpv6_error_dst_unr_send(ICMPV6_ERROR_DST_UNR_ADDR, pkt);
+        gnrc_pktbuf_release(pkt);
     }
+
+    _timer_update(xtimer_now_usec());
+    mutex_unlock(&_lock);
 }
 
+void aodvv2_buffer_tick(void)
+{
+    mutex_lock(&_lock);
+    _timer_set = false;
+
+    uint32_t now = xtimer_now_usec();
+
+    _expire(now);
+
+    /* Send one packet per destination that has a route */
+    for (unsigned i = 0; i < ARRAY_SIZE(_queues); i++) {
+        buffer_queue_t *queue = &_queues[i];
+        if (!queue->used || !queue->dispatch) {
+            continue;
+        }
+
+        gnrc_pktsnip_t *pkt = _queue_pop(queue);
+        int res = gnrc_netapi_dispatch_send(GNRC_NETTYPE_IPV6,
+                                            GNRC_NETREG_DEMUX_CTX_ALL, pkt);
+        if (res < 1) {
+            DEBUG_PUTS("aodvv2: couldn't dispatch packet!");
+            gnrc_pktbuf_release(pkt);
+        }
+    }
+
+    _timer_update(now);
+    mutex_unlock(&_lock);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 node energy
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ * @}
+ */
+
+#include "net/aodvv2/energy.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#if CONFIG_AODVV2_ENERGY_CRITICAL_SOC > 100
+#error "CONFIG_AODVV2_ENERGY_CRITICAL_SOC is a percentage"
+#endif
+
+/**
+ * @brief   Cached fuel gauge readings, only accessed by the AODVv2 thread
+ */
+static uint8_t _soc;
+static bool _charging;
+
+#if IS_USED(MODULE_BQ27441)
+static bq27441_t *_gauge;
+#endif
+
+void aodvv2_energy_init(void)
+{
+    _soc = AODVV2_ENERGY_SOC_UNKNOWN;
+    _charging = false;
+}
+
+#if IS_USED(MODULE_BQ27441)
+void aodvv2_energy_set_gauge(bq27441_t *dev)
+{
+    _gauge = dev;
+}
+#endif
+
+void aodvv2_energy_update(void)
+{
+#if IS_USED(MODULE_BQ27441)
+    bq27441_t *gauge = _gauge;
+    if (gauge == NULL) {
+        return;
+    }
+
+    uint16_t soc;
+    int16_t power;
+
+    /* Keep the previous values if the gauge can't be read */
+    if (bq27441_state_of_charge(gauge, &soc) != BQ27441_OK ||
+        bq27441_average_power(gauge, &power) != BQ27441_OK) {
+        DEBUG_PUTS("aodvv2: can't read fuel gauge");
+        return;
+    }
+
+    _soc = soc > 100 ? 100 : soc;
+    /* Average power is positive while charging */
+    _charging = power > 0;
+
+    DEBUG("aodvv2: state of charge %u%%, average power %d mW\n",
+          (unsigned)_soc, power);
+#endif
+}
+
+uint8_t aodvv2_energy_soc(void)
+{
+    return _soc;
+}
+
+bool aodvv2_energy_is_charging(void)
+{
+    return _charging;
+}
+
+bool aodvv2_energy_is_critical(void)
+{
+    return _soc != AODVV2_ENERGY_SOC_UNKNOWN && !_charging &&
+           _soc <= CONFIG_AODVV2_ENERGY_CRITICAL_SOC;
+}
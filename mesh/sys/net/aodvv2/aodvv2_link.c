@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 L2 transmission feedback
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ * @}
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "aodvv2_link.h"
+
+#include "net/aodvv2.h"
+#include "net/gnrc/netif/hdr.h"
+
+#include "msg.h"
+#include "mutex.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+/**
+ * @brief   Outcome of a unicast frame
+ */
+typedef struct {
+    uint8_t l2addr[GNRC_NETIF_L2ADDR_MAXLEN]; /**< Destination */
+    uint8_t l2addr_len;                        /**< Length of @ref l2addr */
+    bool success;                              /**< Was it acknowledged? */
+} link_event_t;
+
+static gnrc_netif_t *_netif;
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+
+/**
+ * @brief   Original operations and event callback of the interface
+ */
+static const gnrc_netif_ops_t *_netif_ops;
+static gnrc_netif_ops_t _ops;
+static netdev_event_cb_t _event_cb;
+
+/**
+ * @brief   Destination of the frame being sent, only accessed by the
+ *          interface thread. Empty for broadcast and multicast frames.
+ */
+static link_event_t _in_flight;
+
+/**
+ * @brief   Queue of outcomes for the AODVv2 thread
+ */
+static link_event_t _events[CONFIG_AODVV2_LINK_EVENTS];
+static unsigned _events_head;
+static unsigned _events_num;
+static bool _notified;
+static mutex_t _events_lock = MUTEX_INIT;
+static msg_t _link_msg = { .type = AODVV2_MSG_TYPE_LINK_TX };
+
+static void _event_push(bool success)
+{
+    if (_in_flight.l2addr_len == 0) {
+        return;
+    }
+
+    _in_flight.success = success;
+
+    mutex_lock(&_events_lock);
+    bool notify = !_notified;
+    _notified = true;
+    if (_events_num < ARRAY_SIZE(_events)) {
+        unsigned i = (_events_head + _events_num) % ARRAY_SIZE(_events);
+        _events[i] = _in_flight;
+        _events_num++;
+    }
+    else {
+        DEBUG_PUTS("aodvv2: link event queue full");
+    }
+    mutex_unlock(&_events_lock);
+
+    _in_flight.l2addr_len = 0;
+
+    /* Never block the interface thread, one message drains the queue. If
+     * it can't be sent the next outcome tries again */
+    if (notify && msg_try_send(&_link_msg, _pid) != 1) {
+        DEBUG_PUTS("aodvv2: couldn't notify link event");
+        mutex_lock(&_events_lock);
+        _notified = false;
+        mutex_unlock(&_events_lock);
+    }
+}
+
+static int _send(gnrc_netif_t *netif, gnrc_pktsnip_t *pkt)
+{
+    gnrc_netif_hdr_t *hdr = pkt->data;
+
+    _in_flight.l2addr_len = 0;
+    if (pkt->type == GNRC_NETTYPE_NETIF &&
+        !(hdr->flags & (GNRC_NETIF_HDR_FLAGS_BROADCAST |
+                        GNRC_NETIF_HDR_FLAGS_MULTICAST)) &&
+        hdr->dst_l2addr_len > 0 &&
+        hdr->dst_l2addr_len <= sizeof(_in_flight.l2addr)) {
+        memcpy(_in_flight.l2addr, gnrc_netif_hdr_get_dst_addr(hdr),
+               hdr->dst_l2addr_len);
+        _in_flight.l2addr_len = hdr->dst_l2addr_len;
+    }
+
+    int res = _netif_ops->send(netif, pkt);
+    if (res < 0) {
+        /* Didn't reach the air, it says nothing about the link */
+        _in_flight.l2addr_len = 0;
+    }
+
+    return res;
+}
+
+static void _netdev_event_cb(netdev_t *dev, netdev_event_t event)
+{
+    switch (event) {
+        case NETDEV_EVENT_TX_COMPLETE:
+            _event_push(true);
+            break;
+
+        case NETDEV_EVENT_TX_NOACK:
+            _event_push(false);
+            break;
+
+        case NETDEV_EVENT_TX_MEDIUM_BUSY:
+            /* Channel access failed, the neighbor wasn't tried */
+            _in_flight.l2addr_len = 0;
+            break;
+
+        default:
+            break;
+    }
+
+    _event_cb(dev, event);
+}
+
+void aodvv2_link_init(gnrc_netif_t *netif, kernel_pid_t pid)
+{
+    assert(netif != NULL && netif->dev != NULL);
+
+    if (_netif != NULL) {
+        return;
+    }
+
+    _netif = netif;
+    _pid = pid;
+
+    _netif_ops = netif->ops;
+    _ops = *netif->ops;
+    _ops.send = _send;
+    _event_cb = netif->dev->event_callback;
+
+    /* The interface thread may be using them right now, both are replaced
+     * with a single store */
+    netif->ops = &_ops;
+    netif->dev->event_callback = _netdev_event_cb;
+}
+
+bool aodvv2_link_event_get(ipv6_addr_t *neighbor, bool *success)
+{
+    assert(neighbor != NULL && success != NULL);
+
+    while (1) {
+        link_event_t event;
+
+        mutex_lock(&_events_lock);
+        if (_events_num == 0) {
+            /* Drained, the next outcome notifies again */
+            _notified = false;
+            mutex_unlock(&_events_lock);
+            return false;
+        }
+        event = _events[_events_head];
+        _events_head = (_events_head + 1) % ARRAY_SIZE(_events);
+        _events_num--;
+        mutex_unlock(&_events_lock);
+
+        eui64_t iid;
+        if (gnrc_netif_ipv6_iid_from_addr(_netif, event.l2addr,
+                                          event.l2addr_len, &iid) < 0) {
+            DEBUG_PUTS("aodvv2: can't build IID of neighbor");
+            continue;
+        }
+
+        memset(neighbor, 0, sizeof(*neighbor));
+        ipv6_addr_set_link_local_prefix(neighbor);
+        ipv6_addr_set_aiid(neighbor, iid.uint8);
+        *success = event.success;
+
+        return true;
+    }
+}
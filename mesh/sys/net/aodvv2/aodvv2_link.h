@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 L2 transmission feedback
+ *
+ * GNRC doesn't tell other threads whether a unicast frame was acknowledged,
+ * so the netdev event callback and the send operation of the interface are
+ * wrapped to learn the outcome of every unicast frame. The outcomes are
+ * queued here by the interface thread and taken by the AODVv2 thread.
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ */
+
+#ifndef AODVV2_LINK_H
+#define AODVV2_LINK_H
+
+#include <stdbool.h>
+
+#include "net/gnrc/netif.h"
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of transmission outcomes queued for the AODVv2 thread
+ */
+#ifndef CONFIG_AODVV2_LINK_EVENTS
+#define CONFIG_AODVV2_LINK_EVENTS (8)
+#endif
+
+/**
+ * @brief   Start watching the unicast transmissions of an interface
+ *
+ * @param[in] netif Interface.
+ * @param[in] pid   Thread receiving @ref AODVV2_MSG_TYPE_LINK_TX when
+ *                  outcomes are queued.
+ */
+void aodvv2_link_init(gnrc_netif_t *netif, kernel_pid_t pid);
+
+/**
+ * @brief   Take the oldest queued transmission outcome
+ *
+ * @param[out] neighbor Link-local address of the neighbor the frame was
+ *                      sent to.
+ * @param[out] success  true if the frame was acknowledged.
+ *
+ * @return true if an outcome was taken, false if the queue is empty.
+ */
+bool aodvv2_link_event_get(ipv6_addr_t *neighbor, bool *success);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* AODVV2_LINK_H */
+/** @} */
@@ -21,6 +21,9 @@
 
 #include "net/aodvv2/conf.h"
 #include "net/aodvv2/lrs.h"
+#include "net/aodvv2/metric.h"
+#include "net/aodvv2/rcs.h"
+#include "net/aodvv2/timers.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
@@ -44,10 +47,7 @@ typedef struct {
 static lrs_entry_t routing_table[CONFIG_AODVV2_MAX_ROUTING_ENTRIES];
 
 static timex_t null_time;
-static timex_t max_seqnum_lifetime;
 static timex_t active_interval;
-static timex_t max_idletime;
-static timex_t validity_t;
 static timex_t now;
 
 void aodvv2_lrs_init(void)
@@ -55,11 +55,7 @@ void aodvv2_lrs_init(void)
     DEBUG("aodvv2_lrs_init()\n");
 
     null_time = timex_set(0, 0);
-    max_seqnum_lifetime = timex_set(CONFIG_AODVV2_MAX_SEQNUM_LIFETIME, 0);
     active_interval = timex_set(CONFIG_AODVV2_ACTIVE_INTERVAL, 0);
-    max_idletime = timex_set(CONFIG_AODVV2_MAX_IDLETIME, 0);
-    validity_t = timex_set(CONFIG_AODVV2_ACTIVE_INTERVAL +
-                           CONFIG_AODVV2_MAX_IDLETIME, 0);
 
     memset(&routing_table, 0, sizeof(routing_table));
 }
@@ -120,6 +116,100 @@ void aodvv2_lrs_delete_entry(ipv6_addr_t *addr, routing_metric_t metric_type)
     }
 }
 
+unsigned aodvv2_lrs_set_broken(const ipv6_addr_t *next_hop)
+{
+    unsigned num = 0;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(routing_table); i++) {
+        _reset_entry_if_stale(i);
+
+        aodvv2_local_route_t *route = &routing_table[i].route;
+        if (routing_table[i].used &&
+            (route->state == ROUTE_STATE_ACTIVE ||
+             route->state == ROUTE_STATE_IDLE) &&
+            ipv6_addr_equal(&route->next_hop, next_hop)) {
+            route->state = ROUTE_STATE_BROKEN;
+            route->last_used = now; /* mark the time entry was set to Broken */
+            num++;
+        }
+    }
+
+    return num;
+}
+
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)
+static void _alt_remove(aodvv2_local_route_t *route, unsigned i)
+{
+    route->num_alts--;
+    memmove(&route->alts[i], &route->alts[i + 1],
+            (route->num_alts - i) * sizeof(route->alts[0]));
+}
+
+static void _alt_remove_hop(aodvv2_local_route_t *route,
+                            const ipv6_addr_t *next_hop)
+{
+    for (unsigned i = 0; i < route->num_alts; i++) {
+        if (ipv6_addr_equal(&route->alts[i].next_hop, next_hop)) {
+            _alt_remove(route, i);
+            return;
+        }
+    }
+}
+
+/*
+ * Drop the alternates that don't hold for a route updated to seqnum, metric
+ * and next_hop: all of them on a new SeqNum, otherwise the ones that are no
+ * longer loop-free
+ */
+static void _alts_update(aodvv2_local_route_t *route, aodvv2_seqnum_t seqnum,
+                         uint8_t metric, const ipv6_addr_t *next_hop)
+{
+    if (aodvv2_seqnum_cmp(route->seqnum, seqnum) != 0) {
+        route->num_alts = 0;
+        return;
+    }
+
+    _alt_remove_hop(route, next_hop);
+    for (unsigned i = route->num_alts; i > 0; i--) {
+        if (route->alts[i - 1].adv_metric >= metric) {
+            _alt_remove(route, i - 1);
+        }
+    }
+}
+#endif
+
+aodvv2_local_route_t *aodvv2_lrs_failover(const ipv6_addr_t *next_hop)
+{
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)
+    for (unsigned i = 0; i < ARRAY_SIZE(routing_table); i++) {
+        _reset_entry_if_stale(i);
+
+        aodvv2_local_route_t *route = &routing_table[i].route;
+        if (!routing_table[i].used) {
+            continue;
+        }
+
+        _alt_remove_hop(route, next_hop);
+
+        if ((route->state == ROUTE_STATE_ACTIVE ||
+             route->state == ROUTE_STATE_IDLE) &&
+            ipv6_addr_equal(&route->next_hop, next_hop) &&
+            route->num_alts > 0) {
+            DEBUG_PUTS("aodvv2: switching route to alternate next hop");
+            /* The metric stays the one we advertised, the alternate is
+             * loop-free against it */
+            route->next_hop = route->alts[0].next_hop;
+            _alt_remove(route, 0);
+            return route;
+        }
+    }
+
+    return NULL;
+#else
+    (void)next_hop;
+    return NULL;
+#endif
+}
 
 /*
  * Check if entry at index i is stale as described in Section 6.3.
@@ -172,6 +262,8 @@ static void _reset_entry_if_stale(uint8_t i)
 
     /* After that time, old sequence number information is considered no longer
      * valuable and the Expired route MUST BE expunged */
+    timex_t max_seqnum_lifetime = timex_set(aodvv2_timers_seqnum_lifetime(),
+                                            0);
     if (timex_cmp(timex_sub(now, last_used), max_seqnum_lifetime) >= 0) {
         memset(&routing_table[i].route, 0, sizeof(aodvv2_local_route_t));
     }
@@ -180,48 +272,124 @@ static void _reset_entry_if_stale(uint8_t i)
 bool aodvv2_lrs_offers_improvement(aodvv2_local_route_t *rt_entry,
                                    node_data_t *node_data)
 {
+    int16_t seqcmp = aodvv2_seqnum_cmp(rt_entry->seqnum, node_data->seqnum);
+
+    /* The closest gateway wins, their SeqNums can't be compared so the
+     * current route is kept on a tie. A RREP from another one switches
+     * over a route that no longer works */
+    if (aodvv2_rcs_is_gateway(&rt_entry->addr)) {
+        if (rt_entry->state == ROUTE_STATE_BROKEN ||
+            rt_entry->state == ROUTE_STATE_EXPIRED) {
+            return true;
+        }
+        return node_data->metric < rt_entry->metric;
+    }
+
     /* Check if new info is stale */
-    if (aodvv2_seqnum_cmp(node_data->seqnum, rt_entry->seqnum) < 0) {
+    if (seqcmp < 0) {
         return false;
     }
-    /* Check if new info is more costly */
-    if ((node_data->metric >= rt_entry->metric)
-        && !(rt_entry->state != ROUTE_STATE_BROKEN)) {
+    /* Newer info always improves the route */
+    if (seqcmp > 0) {
+        return true;
+    }
+    /* Check if new info repairs a broken route without creating a loop */
+    if (rt_entry->state == ROUTE_STATE_BROKEN) {
+        return aodvv2_metric_loop_free(rt_entry->metric_type,
+                                       node_data->metric, rt_entry->metric);
+    }
+    /* Check if new info is less costly, its metric already includes the
+     * cost of the link it was received on */
+    return node_data->metric < rt_entry->metric;
+}
+
+bool aodvv2_lrs_add_alternate(aodvv2_local_route_t *rt_entry,
+                              const node_data_t *node_data,
+                              const ipv6_addr_t *next_hop, uint8_t link_cost)
+{
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)
+    if (rt_entry->state == ROUTE_STATE_BROKEN ||
+        aodvv2_seqnum_cmp(rt_entry->seqnum, node_data->seqnum) != 0 ||
+        ipv6_addr_equal(&rt_entry->next_hop, next_hop)) {
         return false;
     }
-    /* Check if new info repairs a broken route */
-    if (!(rt_entry->state != ROUTE_STATE_BROKEN)) {
+
+    /* A neighbor closer to the destination than us can't route through us,
+     * equal metrics aren't enough for that */
+    uint8_t adv_metric = node_data->metric - link_cost;
+    if (link_cost > node_data->metric || adv_metric >= rt_entry->metric) {
         return false;
     }
+
+    _alt_remove_hop(rt_entry, next_hop);
+
+    unsigned i = rt_entry->num_alts;
+    if (i == ARRAY_SIZE(rt_entry->alts)) {
+        if (node_data->metric >= rt_entry->alts[i - 1].metric) {
+            return false;
+        }
+        i--;
+    }
+    else {
+        rt_entry->num_alts++;
+    }
+
+    /* Keep them sorted, best first */
+    for (; i > 0 && rt_entry->alts[i - 1].metric > node_data->metric; i--) {
+        rt_entry->alts[i] = rt_entry->alts[i - 1];
+    }
+
+    DEBUG_PUTS("aodvv2: adding alternate next hop");
+    rt_entry->alts[i].next_hop = *next_hop;
+    rt_entry->alts[i].metric = node_data->metric;
+    rt_entry->alts[i].adv_metric = adv_metric;
+
     return true;
+#else
+    (void)rt_entry;
+    (void)node_data;
+    (void)next_hop;
+    (void)link_cost;
+    return false;
+#endif
 }
 
 void aodvv2_lrs_fill_routing_entry_rreq(aodvv2_message_t *msg,
-                                        aodvv2_local_route_t *rt_entry,
-                                        uint8_t link_cost)
+                                        aodvv2_local_route_t *rt_entry)
 {
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)
+    _alts_update(rt_entry, msg->orig_node.seqnum, msg->orig_node.metric,
+                 &msg->sender);
+#endif
     rt_entry->addr = msg->orig_node.addr;
     rt_entry->pfx_len = msg->orig_node.pfx_len;
     rt_entry->seqnum = msg->orig_node.seqnum;
     rt_entry->next_hop = msg->sender;
     rt_entry->last_used = msg->timestamp;
-    rt_entry->expiration_time = timex_add(msg->timestamp, validity_t);
+    rt_entry->expiration_time =
+        timex_add(msg->timestamp,
+                  timex_set(aodvv2_timers_route_lifetime(), 0));
     rt_entry->metric_type = msg->metric_type;
-    rt_entry->metric = msg->orig_node.metric + link_cost;
+    rt_entry->metric = msg->orig_node.metric;
     rt_entry->state = ROUTE_STATE_ACTIVE;
 }
 
 void aodvv2_lrs_fill_routing_entry_rrep(aodvv2_message_t *msg,
-                                        aodvv2_local_route_t *rt_entry,
-                                        uint8_t link_cost)
+                                        aodvv2_local_route_t *rt_entry)
 {
+#if IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)
+    _alts_update(rt_entry, msg->targ_node.seqnum, msg->targ_node.metric,
+                 &msg->sender);
+#endif
     rt_entry->addr = msg->targ_node.addr;
     rt_entry->pfx_len = msg->targ_node.pfx_len;
     rt_entry->seqnum = msg->targ_node.seqnum;
     rt_entry->next_hop = msg->sender;
     rt_entry->last_used = msg->timestamp;
-    rt_entry->expiration_time = timex_add(msg->timestamp, validity_t);
+    rt_entry->expiration_time =
+        timex_add(msg->timestamp,
+                  timex_set(aodvv2_timers_route_lifetime(), 0));
     rt_entry->metric_type = msg->metric_type;
-    rt_entry->metric = msg->targ_node.metric + link_cost;
+    rt_entry->metric = msg->targ_node.metric;
     rt_entry->state = ROUTE_STATE_ACTIVE;
 }
@@ -22,6 +22,7 @@
 
 #include "net/aodvv2/conf.h"
 #include "net/aodvv2/mcmsg.h"
+#include "net/aodvv2/timers.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
@@ -34,7 +35,10 @@ typedef struct {
 static internal_entry_t _entries[CONFIG_AODVV2_MCMSG_MAX_ENTRIES];
 static mutex_t _lock = MUTEX_INIT;
 
-static timex_t _max_seqnum_lifetime;
+static timex_t _seqnum_lifetime(void)
+{
+    return timex_set(aodvv2_timers_seqnum_lifetime(), 0);
+}
 
 static void _reset_entry_if_stale(internal_entry_t *entry)
 {
@@ -134,7 +138,7 @@ static internal_entry_t *_add(aodvv2_message_t *msg)
             entry->data.orig_seqnum = msg->orig_node.seqnum;
 
             entry->data.timestamp = current_time;
-            entry->data.removal_time = timex_add(current_time, _max_seqnum_lifetime);
+            entry->data.removal_time = timex_add(current_time, _seqnum_lifetime());
             return entry;
         }
     }
@@ -147,8 +151,6 @@ void aodvv2_mcmsg_init(void)
     DEBUG_PUTS("aodvv2: init McMset set");
     mutex_lock(&_lock);
 
-    _max_seqnum_lifetime = timex_set(CONFIG_AODVV2_MAX_SEQNUM_LIFETIME, 0);
-
     memset(&_entries, 0, sizeof(_entries));
     mutex_unlock(&_lock);
 }
@@ -174,7 +176,7 @@ int aodvv2_mcmsg_process(aodvv2_message_t *msg)
     xtimer_now_timex(&current_time);
 
     comparable->data.timestamp = current_time;
-    comparable->data.removal_time = timex_add(current_time, _max_seqnum_lifetime);
+    comparable->data.removal_time = timex_add(current_time, _seqnum_lifetime());
 
     int seqcmp = aodvv2_seqnum_cmp(comparable->data.orig_seqnum, msg->orig_node.seqnum);
     if (seqcmp < 0) {
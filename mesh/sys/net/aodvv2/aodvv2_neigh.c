@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 Neighbor Set
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ * @}
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "net/aodvv2/conf.h"
+#include "net/aodvv2/neigh.h"
+
+#include "xtimer.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#if CONFIG_AODVV2_ETX_WINDOW < 2 || CONFIG_AODVV2_ETX_WINDOW > 16
+#error "CONFIG_AODVV2_ETX_WINDOW must be between 2 and 16"
+#endif
+
+#if CONFIG_AODVV2_HELLO_INTERVAL_MIN < 1 || \
+    CONFIG_AODVV2_HELLO_INTERVAL_MAX < CONFIG_AODVV2_HELLO_INTERVAL_MIN
+#error "CONFIG_AODVV2_HELLO_INTERVAL_MIN/MAX are invalid"
+#endif
+
+/**
+ * @brief   Container for @ref aodvv2_neigh_t
+ */
+typedef struct {
+    aodvv2_neigh_t neigh; /**< Neighbor */
+    bool used;            /**< Is this entry used? */
+} neigh_entry_t;
+
+/**
+ * @brief   Memory for the Neighbor Set, only accessed by the AODVv2 thread
+ */
+static neigh_entry_t _entries[CONFIG_AODVV2_NEIGH_ENTRIES];
+
+static aodvv2_neigh_lost_cb_t _lost_cb;
+static bool _changed;
+
+/*
+ * Forget the neighbor at index i if it wasn't heard within its validity
+ * time. Only neighbors running HELLOs are lost, others may just be quiet.
+ */
+static void _reset_entry_if_stale(unsigned i, timex_t now)
+{
+    if (!_entries[i].used) {
+        return;
+    }
+
+    if (timex_cmp(now, _entries[i].neigh.expires) >= 0) {
+        ipv6_addr_t addr = _entries[i].neigh.addr;
+        bool hello = _entries[i].neigh.hello_span > 0;
+
+        memset(&_entries[i], 0, sizeof(_entries[i]));
+
+        if (hello) {
+            DEBUG_PUTS("aodvv2: neighbor lost");
+            _changed = true;
+            if (_lost_cb != NULL) {
+                _lost_cb(&addr);
+            }
+        }
+    }
+}
+
+static unsigned _popcount(uint16_t value)
+{
+    unsigned count = 0;
+
+    while (value) {
+        value &= value - 1;
+        count++;
+    }
+
+    return count;
+}
+
+void aodvv2_neigh_init(void)
+{
+    _changed = false;
+    memset(_entries, 0, sizeof(_entries));
+}
+
+void aodvv2_neigh_set_lost_cb(aodvv2_neigh_lost_cb_t cb)
+{
+    _lost_cb = cb;
+}
+
+aodvv2_neigh_t *aodvv2_neigh_get(const ipv6_addr_t *addr)
+{
+    assert(addr != NULL);
+
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries); i++) {
+        _reset_entry_if_stale(i, now);
+
+        if (_entries[i].used &&
+            ipv6_addr_equal(&_entries[i].neigh.addr, addr)) {
+            return &_entries[i].neigh;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Get the neighbor for addr, adding it in a free entry or in the one heard
+ * least recently
+ */
+static aodvv2_neigh_t *_neigh_get_or_add(const ipv6_addr_t *addr)
+{
+    aodvv2_neigh_t *neigh = aodvv2_neigh_get(addr);
+    if (neigh != NULL) {
+        return neigh;
+    }
+
+    neigh_entry_t *entry = &_entries[0];
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries) && entry->used; i++) {
+        if (!_entries[i].used ||
+            timex_cmp(_entries[i].neigh.last_heard,
+                      entry->neigh.last_heard) < 0) {
+            entry = &_entries[i];
+        }
+    }
+
+    DEBUG_PUTS("aodvv2: adding neighbor");
+    memset(entry, 0, sizeof(*entry));
+    entry->used = true;
+    entry->neigh.addr = *addr;
+    xtimer_now_timex(&entry->neigh.last_heard);
+    entry->neigh.expires = timex_add(entry->neigh.last_heard,
+                                     timex_set(CONFIG_AODVV2_NEIGH_HOLD_TIME,
+                                               0));
+
+    return &entry->neigh;
+}
+
+/*
+ * Exponentially weighted moving average of avg and sample, both with
+ * AODVV2_NEIGH_EWMA_FRAC fractional bits
+ */
+static int32_t _ewma(int32_t avg, int32_t sample)
+{
+    return avg + ((sample - avg) / (1 << CONFIG_AODVV2_LQL_EWMA_SHIFT));
+}
+
+/*
+ * Slide the window of received HELLOs to seqnum, false if it's a duplicate
+ */
+static bool _hello_window(aodvv2_neigh_t *neigh, uint16_t seqnum)
+{
+    /* hello_span is 0 until the first HELLO of the neighbor */
+    if (neigh->hello_span > 0) {
+        uint16_t diff = seqnum - neigh->hello_seqnum;
+
+        if (diff == 0) {
+            return false;
+        }
+
+        if (diff <= CONFIG_AODVV2_ETX_WINDOW) {
+            /* HELLOs in between were lost */
+            neigh->hello_rcvd <<= diff - 1;
+            neigh->hello_span += diff - 1;
+        }
+        else if (diff < (UINT16_MAX / 2)) {
+            /* Nothing heard for a whole window */
+            neigh->hello_rcvd = 0;
+            neigh->hello_span = CONFIG_AODVV2_ETX_WINDOW;
+        }
+        else {
+            /* Neighbor restarted, start measuring again */
+            neigh->hello_rcvd = 0;
+            neigh->hello_span = 0;
+        }
+    }
+
+    neigh->hello_seqnum = seqnum;
+    neigh->hello_rcvd = (neigh->hello_rcvd << 1) | 1;
+    neigh->hello_span++;
+    if (neigh->hello_span > CONFIG_AODVV2_ETX_WINDOW) {
+        neigh->hello_span = CONFIG_AODVV2_ETX_WINDOW;
+    }
+
+    uint16_t mask = (1U << neigh->hello_span) - 1;
+    neigh->rev_ratio = (_popcount(neigh->hello_rcvd & mask) *
+                        AODVV2_NEIGH_RATIO_MAX) / neigh->hello_span;
+
+    return true;
+}
+
+static void _set_link(aodvv2_neigh_t *neigh, aodvv2_neigh_link_t link)
+{
+    if (neigh->link != link) {
+        DEBUG("aodvv2: link to neighbor is now %s\n",
+              link == AODVV2_NEIGH_LINK_SYMMETRIC ? "symmetric" : "heard");
+        neigh->link = link;
+        _changed = true;
+    }
+}
+
+aodvv2_neigh_t *aodvv2_neigh_hello_rcvd(const ipv6_addr_t *addr,
+                                        uint16_t seqnum, uint32_t validity,
+                                        bool listed)
+{
+    assert(addr != NULL);
+
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    aodvv2_neigh_t *neigh = _neigh_get_or_add(addr);
+    bool new_hello = _hello_window(neigh, seqnum);
+
+    neigh->last_heard = now;
+    neigh->expires = timex_add(now, timex_set(validity / MS_PER_SEC,
+                                              (validity % MS_PER_SEC) *
+                                              US_PER_MS));
+    neigh->heard = true;
+
+    if (listed) {
+        neigh->sym_misses = 0;
+        neigh->blacklisted = timex_set(0, 0);
+        _set_link(neigh, AODVV2_NEIGH_LINK_SYMMETRIC);
+    }
+    else if (new_hello) {
+        if (neigh->sym_misses < AODVV2_NEIGH_SYM_MISSES) {
+            neigh->sym_misses++;
+        }
+        if (neigh->sym_misses >= AODVV2_NEIGH_SYM_MISSES) {
+            _set_link(neigh, AODVV2_NEIGH_LINK_HEARD);
+        }
+    }
+
+    /* A neighbor running HELLOs is a change until its link is known */
+    if (neigh->link == AODVV2_NEIGH_LINK_UNKNOWN) {
+        _changed = true;
+    }
+
+    return neigh;
+}
+
+aodvv2_neigh_t *aodvv2_neigh_lq_sample(const ipv6_addr_t *addr, int16_t rssi,
+                                       uint8_t lqi)
+{
+    assert(addr != NULL);
+
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    aodvv2_neigh_t *neigh = _neigh_get_or_add(addr);
+    neigh->last_heard = now;
+    neigh->heard = true;
+
+    /* HELLOs announce for how long neighbors running them stay valid */
+    if (neigh->link == AODVV2_NEIGH_LINK_UNKNOWN) {
+        timex_t hold = timex_add(now, timex_set(CONFIG_AODVV2_NEIGH_HOLD_TIME,
+                                                0));
+        if (timex_cmp(hold, neigh->expires) > 0) {
+            neigh->expires = hold;
+        }
+    }
+
+    if (rssi != AODVV2_NEIGH_NO_RSSI) {
+        int32_t sample = (int32_t)rssi * (1 << AODVV2_NEIGH_EWMA_FRAC);
+        neigh->rssi_avg = neigh->has_rssi ? _ewma(neigh->rssi_avg, sample)
+                                          : sample;
+        neigh->has_rssi = true;
+    }
+
+    if (lqi != AODVV2_NEIGH_NO_LQI) {
+        int32_t sample = (int32_t)lqi << AODVV2_NEIGH_EWMA_FRAC;
+        neigh->lqi_avg = neigh->has_lqi ? _ewma(neigh->lqi_avg, sample)
+                                        : sample;
+        neigh->has_lqi = true;
+    }
+
+    return neigh;
+}
+
+bool aodvv2_neigh_tx_result(const ipv6_addr_t *addr, bool success)
+{
+    assert(addr != NULL);
+
+    if (success) {
+        aodvv2_neigh_t *neigh = aodvv2_neigh_get(addr);
+        if (neigh != NULL) {
+            neigh->tx_failures = 0;
+        }
+        return false;
+    }
+
+    aodvv2_neigh_t *neigh = _neigh_get_or_add(addr);
+    if (++neigh->tx_failures < CONFIG_AODVV2_LINK_BREAK_FAILURES) {
+        return false;
+    }
+
+    DEBUG_PUTS("aodvv2: link to neighbor broke");
+    neigh->tx_failures = 0;
+
+    /* Keep the neighbor at least as long as it's blacklisted */
+    timex_t now;
+    xtimer_now_timex(&now);
+    neigh->blacklisted = timex_add(now,
+                                   timex_set(CONFIG_AODVV2_MAX_BLACKLIST_TIME,
+                                             0));
+    if (timex_cmp(neigh->blacklisted, neigh->expires) > 0) {
+        neigh->expires = neigh->blacklisted;
+    }
+    _changed = true;
+
+    return true;
+}
+
+bool aodvv2_neigh_is_blacklisted(const ipv6_addr_t *addr)
+{
+    assert(addr != NULL);
+
+    aodvv2_neigh_t *neigh = aodvv2_neigh_get(addr);
+    if (neigh == NULL) {
+        return false;
+    }
+
+    if (neigh->link == AODVV2_NEIGH_LINK_HEARD) {
+        return true;
+    }
+
+    timex_t now;
+    xtimer_now_timex(&now);
+    return timex_cmp(now, neigh->blacklisted) < 0;
+}
+
+void aodvv2_neigh_expire(void)
+{
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries); i++) {
+        _reset_entry_if_stale(i, now);
+    }
+}
+
+bool aodvv2_neigh_changed(void)
+{
+    bool changed = _changed;
+    _changed = false;
+    return changed;
+}
+
+const aodvv2_neigh_t *aodvv2_neigh_hello_next(unsigned *state)
+{
+    assert(state != NULL);
+
+    while (*state < ARRAY_SIZE(_entries)) {
+        unsigned i = (*state)++;
+
+        if (_entries[i].used && _entries[i].neigh.heard) {
+            return &_entries[i].neigh;
+        }
+    }
+
+    return NULL;
+}
@@ -20,6 +20,8 @@
  * @}
  */
 
+#include <assert.h>
+
 #include "net/aodvv2/rcs.h"
 
 #include "mutex.h"
@@ -38,11 +40,23 @@ typedef struct {
 static internal_entry_t _entries[CONFIG_AODVV2_RCS_ENTRIES];
 static mutex_t _lock = MUTEX_INIT;
 
+/**
+ * @brief   Gateway anycast prefix, parsed from
+ *          @ref CONFIG_AODVV2_GATEWAY_PREFIX
+ */
+static ipv6_addr_t _gateway_prefix;
+
 void aodvv2_rcs_init(void)
 {
     mutex_lock(&_lock);
     memset(_entries, 0, sizeof(_entries));
     mutex_unlock(&_lock);
+
+    if (ipv6_addr_from_str(&_gateway_prefix,
+                           CONFIG_AODVV2_GATEWAY_PREFIX) == NULL) {
+        DEBUG_PUTS("aodvv2: invalid gateway prefix");
+        assert(false);
+    }
 }
 
 aodvv2_rcs_entry_t *aodvv2_rcs_add(const ipv6_addr_t *addr, uint8_t pfx_len,
@@ -152,6 +166,47 @@ aodvv2_rcs_entry_t *aodvv2_rcs_is_client(const ipv6_addr_t *addr)
     return NULL;
 }
 
+aodvv2_rcs_entry_t *aodvv2_rcs_gateway_add(uint8_t cost)
+{
+    return aodvv2_rcs_add(&_gateway_prefix, CONFIG_AODVV2_GATEWAY_PREFIX_LEN,
+                          cost);
+}
+
+void aodvv2_rcs_gateway_del(void)
+{
+    aodvv2_rcs_del(&_gateway_prefix, CONFIG_AODVV2_GATEWAY_PREFIX_LEN);
+}
+
+bool aodvv2_rcs_is_gateway(const ipv6_addr_t *addr)
+{
+    assert(addr != NULL);
+
+    return ipv6_addr_match_prefix(&_gateway_prefix, addr) >=
+           CONFIG_AODVV2_GATEWAY_PREFIX_LEN;
+}
+
+unsigned aodvv2_rcs_get_entries(aodvv2_rcs_entry_t *entries, unsigned max)
+{
+    assert(entries != NULL);
+
+    unsigned num = 0;
+
+    mutex_lock(&_lock);
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries) && num < max; i++) {
+        internal_entry_t *entry = &_entries[i];
+
+        /* Skip unused entries */
+        if (!entry->used) {
+            continue;
+        }
+
+        entries[num++] = entry->data;
+    }
+    mutex_unlock(&_lock);
+
+    return num;
+}
+
 void aodvv2_rcs_print_entries(void)
 {
     char buf[IPV6_ADDR_MAX_STR_LEN];
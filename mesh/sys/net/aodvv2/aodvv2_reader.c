@@ -20,41 +20,66 @@
  * @}
  */
 
+#include <assert.h>
+
 #include "aodvv2_reader.h"
 #include "net/aodvv2.h"
+#include "net/aodvv2/energy.h"
 #include "net/aodvv2/lrs.h"
 #include "net/aodvv2/mcmsg.h"
 #include "net/aodvv2/metric.h"
+#include "net/aodvv2/neigh.h"
 #include "net/aodvv2/rcs.h"
 #include "net/aodvv2/rfc5444.h"
+#include "net/aodvv2/rreq_data.h"
+#include "net/aodvv2/timers.h"
 #include "net/manet.h"
 
-#include "net/gnrc/ipv6/nib/ft.h"
-
 #include "xtimer.h"
 
+#include "rfc5444/rfc5444.h"
+
 #include "rfc5444_compat.h"
 
 #define ENABLE_DEBUG (0)
 #include "debug.h"
 
-#define AODVV2_ROUTE_LIFETIME \
-    (CONFIG_AODVV2_ACTIVE_INTERVAL + CONFIG_AODVV2_MAX_IDLETIME)
+static enum rfc5444_result _cb_msg_start(
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_blocktlv_messagetlvs_okay(
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_addr_start(
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_addr_tlv(
+    struct rfc5444_reader_tlvblock_entry *entry,
+    struct rfc5444_reader_tlvblock_context *cont);
 
 static enum rfc5444_result _cb_rrep_blocktlv_addresstlvs_okay(
     struct rfc5444_reader_tlvblock_context *cont);
-static enum rfc5444_result _cb_rrep_blocktlv_messagetlvs_okay(
-    struct rfc5444_reader_tlvblock_context *cont);
 static enum rfc5444_result _cb_rrep_end_callback(
     struct rfc5444_reader_tlvblock_context *cont, bool dropped);
 
-static enum rfc5444_result _cb_rreq_blocktlv_addresstlvs_okay(
+static enum rfc5444_result _cb_rreq_msg_tlv(
+    struct rfc5444_reader_tlvblock_entry *entry,
     struct rfc5444_reader_tlvblock_context *cont);
-static enum rfc5444_result _cb_rreq_blocktlv_messagetlvs_okay(
+static enum rfc5444_result _cb_rreq_blocktlv_addresstlvs_okay(
     struct rfc5444_reader_tlvblock_context *cont);
 static enum rfc5444_result _cb_rreq_end_callback(
     struct rfc5444_reader_tlvblock_context *cont, bool dropped);
 
+static enum rfc5444_result _cb_hello_msg_tlv(
+    struct rfc5444_reader_tlvblock_entry *entry,
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_hello_addr_start(
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_hello_addr_tlv(
+    struct rfc5444_reader_tlvblock_entry *entry,
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_hello_blocktlv_addresstlvs_okay(
+    struct rfc5444_reader_tlvblock_context *cont);
+static enum rfc5444_result _cb_hello_end_callback(
+    struct rfc5444_reader_tlvblock_context *cont, bool dropped);
+
 /*
  * Message consumer, will be called once for every message of
  * type RFC5444_MSGTYPE_RREP that contains all the mandatory message TLVs
@@ -62,7 +87,8 @@ static enum rfc5444_result _cb_rreq_end_callback(
 static struct rfc5444_reader_tlvblock_consumer _rrep_consumer =
 {
     .msg_id = RFC5444_MSGTYPE_RREP,
-    .block_callback = _cb_rrep_blocktlv_messagetlvs_okay,
+    .start_callback = _cb_msg_start,
+    .block_callback = _cb_blocktlv_messagetlvs_okay,
     .end_callback = _cb_rrep_end_callback,
 };
 
@@ -74,6 +100,8 @@ static struct rfc5444_reader_tlvblock_consumer _rrep_address_consumer =
 {
     .msg_id = RFC5444_MSGTYPE_RREP,
     .addrblock_consumer = true,
+    .start_callback = _cb_addr_start,
+    .tlv_callback = _cb_addr_tlv,
     .block_callback = _cb_rrep_blocktlv_addresstlvs_okay,
 };
 
@@ -84,7 +112,9 @@ static struct rfc5444_reader_tlvblock_consumer _rrep_address_consumer =
 static struct rfc5444_reader_tlvblock_consumer _rreq_consumer =
 {
     .msg_id = RFC5444_MSGTYPE_RREQ,
-    .block_callback = _cb_rreq_blocktlv_messagetlvs_okay,
+    .start_callback = _cb_msg_start,
+    .tlv_callback = _cb_rreq_msg_tlv,
+    .block_callback = _cb_blocktlv_messagetlvs_okay,
     .end_callback = _cb_rreq_end_callback,
 };
 
@@ -96,254 +126,353 @@ static struct rfc5444_reader_tlvblock_consumer _rreq_address_consumer =
 {
     .msg_id = RFC5444_MSGTYPE_RREQ,
     .addrblock_consumer = true,
+    .start_callback = _cb_addr_start,
+    .tlv_callback = _cb_addr_tlv,
     .block_callback = _cb_rreq_blocktlv_addresstlvs_okay,
 };
 
 /*
- * Address consumer entries definition
- * TLV types RFC5444_MSGTLV__SEQNUM and RFC5444_MSGTLV_METRIC
+ * Message consumer, will be called once for every HELLO
  */
-static struct rfc5444_reader_tlvblock_consumer_entry _address_consumer_entries[] =
+static struct rfc5444_reader_tlvblock_consumer _hello_consumer =
 {
-    [RFC5444_MSGTLV_ORIGSEQNUM] = { .type = RFC5444_MSGTLV_ORIGSEQNUM },
-    [RFC5444_MSGTLV_TARGSEQNUM] = { .type = RFC5444_MSGTLV_TARGSEQNUM },
-    [RFC5444_MSGTLV_METRIC] = { .type = RFC5444_MSGTLV_METRIC }
+    .msg_id = RFC6130_MSGTYPE_HELLO,
+    .start_callback = _cb_msg_start,
+    .tlv_callback = _cb_hello_msg_tlv,
+    .end_callback = _cb_hello_end_callback,
 };
 
-static struct netaddr_str nbuf;
-static aodvv2_message_t _msg_data;
-
-static kernel_pid_t _netif_pid = KERNEL_PID_UNDEF;
+/*
+ * Address consumer. Will be called once for every neighbor listed on a
+ * HELLO.
+ */
+static struct rfc5444_reader_tlvblock_consumer _hello_address_consumer =
+{
+    .msg_id = RFC6130_MSGTYPE_HELLO,
+    .addrblock_consumer = true,
+    .start_callback = _cb_hello_addr_start,
+    .tlv_callback = _cb_hello_addr_tlv,
+    .block_callback = _cb_hello_blocktlv_addresstlvs_okay,
+};
 
-static enum rfc5444_result _cb_rrep_blocktlv_messagetlvs_okay(
+static inline aodvv2_reader_ctx_t *_ctx(
         struct rfc5444_reader_tlvblock_context *cont)
 {
-    if (!cont->has_hoplimit) {
+    assert(cont->user_ctx != NULL);
+    return cont->user_ctx;
+}
+
+static void _msg_start(aodvv2_reader_ctx_t *ctx, const uint8_t *msg_buffer,
+                       size_t msg_size)
+{
+    /* Start every message with a clean state */
+    memset(&ctx->msg, 0, sizeof(ctx->msg));
+    ctx->msg.sender = ctx->sender;
+    ctx->msg_buffer = msg_buffer;
+    ctx->msg_size = msg_size;
+    ctx->orig_metric = NULL;
+    memset(&ctx->hello, 0, sizeof(ctx->hello));
+}
+
+static enum rfc5444_result _msg_hoplimit(aodvv2_reader_ctx_t *ctx,
+                                         bool has_hoplimit, uint8_t hoplimit)
+{
+    if (!has_hoplimit) {
         DEBUG_PUTS("aodvv2: missing hop limit");
         return RFC5444_DROP_PACKET;
     }
 
-    _msg_data.msg_hop_limit = cont->hoplimit;
-    if (_msg_data.msg_hop_limit == 0) {
+    ctx->msg.msg_hop_limit = hoplimit;
+    if (ctx->msg.msg_hop_limit == 0) {
         DEBUG_PUTS("aodvv2: hop limit is 0");
         return RFC5444_DROP_PACKET;
     }
 
-    _msg_data.msg_hop_limit--;
+    ctx->msg.msg_hop_limit--;
     return RFC5444_OKAY;
 }
 
-static enum rfc5444_result _cb_rrep_blocktlv_addresstlvs_okay(
-        struct rfc5444_reader_tlvblock_context *cont)
+/**
+ * @brief   Get where to store the next TargPrefix of a message
+ *
+ * The first one goes to the TargNode of the message, the ones of a
+ * multi-target RREQ, or the clients advertised on a RREP, after it.
+ *
+ * @return NULL if the message carries too many TargPrefixes.
+ */
+static node_data_t *_targ_next(aodvv2_reader_ctx_t *ctx)
 {
-    struct rfc5444_reader_tlvblock_entry *tlv;
+    if (ipv6_addr_is_unspecified(&ctx->msg.targ_node.addr)) {
+        return &ctx->msg.targ_node;
+    }
+
+    if (ctx->msg.num_extra_targs == ARRAY_SIZE(ctx->msg.extra_targs)) {
+        DEBUG_PUTS("aodvv2: too many TargPrefixes");
+        return NULL;
+    }
+
+    return &ctx->msg.extra_targs[ctx->msg.num_extra_targs++];
+}
+
+static enum rfc5444_result _rrep_addr(aodvv2_reader_ctx_t *ctx,
+                                       const struct netaddr *addr)
+{
+    const aodvv2_reader_tlv_t *tlv;
+    node_data_t *targ = NULL;
     bool is_targ_node_addr = false;
 
-    DEBUG("aodvv2: %s\n", netaddr_to_string(&nbuf, &cont->addr));
+#if ENABLE_DEBUG == 1
+    struct netaddr_str nbuf;
+    DEBUG("aodvv2: %s\n", netaddr_to_string(&nbuf, addr));
+#endif
+
+    /* handle TargNode SeqNum TLV, the TargRouter may advertise more of its
+     * clients after the TargNode */
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_TARGSEQNUM];
+    if (tlv->value != NULL) {
+        DEBUG("aodvv2: RFC5444_MSGTLV_TARGSEQNUM: %d\n", *tlv->value);
+        targ = _targ_next(ctx);
+        if (targ == NULL) {
+            return RFC5444_DROP_PACKET;
+        }
 
-    /* handle TargNode SeqNum TLV */
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_TARGSEQNUM].tlv;
-    if (tlv) {
-        DEBUG("aodvv2: RFC5444_MSGTLV_TARGSEQNUM: %d\n", *tlv->single_value);
         is_targ_node_addr = true;
-        netaddr_to_ipv6_addr(&cont->addr, &_msg_data.targ_node.addr,
-                             &_msg_data.targ_node.pfx_len);
-        _msg_data.targ_node.seqnum = *tlv->single_value;
+        netaddr_to_ipv6_addr(addr, &targ->addr, &targ->pfx_len);
+        targ->seqnum = *tlv->value;
     }
 
     /* handle OrigNode SeqNum TLV */
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_ORIGSEQNUM].tlv;
-    if (tlv) {
-        DEBUG("aodvv2: RFC5444_MSGTLV_ORIGSEQNUM: %d\n", *tlv->single_value);
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_ORIGSEQNUM];
+    if (tlv->value != NULL) {
+        DEBUG("aodvv2: RFC5444_MSGTLV_ORIGSEQNUM: %d\n", *tlv->value);
         is_targ_node_addr = false;
-        netaddr_to_ipv6_addr(&cont->addr, &_msg_data.orig_node.addr,
-                             &_msg_data.targ_node.pfx_len);
-        _msg_data.orig_node.seqnum = *tlv->single_value;
+        netaddr_to_ipv6_addr(addr, &ctx->msg.orig_node.addr,
+                             &ctx->msg.orig_node.pfx_len);
+        ctx->msg.orig_node.seqnum = *tlv->value;
     }
 
-    if (!tlv && !is_targ_node_addr) {
+    if (tlv->value == NULL && !is_targ_node_addr) {
         DEBUG_PUTS("aodvv2: mandatory SeqNum TLV missing!");
         return RFC5444_DROP_PACKET;
     }
 
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_METRIC].tlv;
-    if (!tlv && is_targ_node_addr) {
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_METRIC];
+    if (tlv->value == NULL && is_targ_node_addr) {
         DEBUG_PUTS("aodvv2: missing or unknown metric TLV!");
         return RFC5444_DROP_PACKET;
     }
 
-    if (tlv) {
+    if (tlv->value != NULL) {
         if (!is_targ_node_addr) {
             DEBUG_PUTS("aodvv2: metric TLV belongs to wrong address!");
             return RFC5444_DROP_PACKET;
         }
 
         DEBUG("aodvv2: RFC5444_MSGTLV_METRIC val: %d, exttype: %d\n",
-              *tlv->single_value, tlv->type_ext);
+              *tlv->value, tlv->type_ext);
 
-        _msg_data.metric_type = tlv->type_ext;
-        _msg_data.orig_node.metric = *tlv->single_value;
+        ctx->msg.metric_type = tlv->type_ext;
+        targ->metric = *tlv->value;
     }
 
     return RFC5444_OKAY;
 }
 
-static enum rfc5444_result _cb_rrep_end_callback(
-        struct rfc5444_reader_tlvblock_context *cont, bool dropped)
+/**
+ * @brief   Add or improve the route to a TargNode of a RREP
+ *
+ * A RREP that offers no improvement may still give an alternate next hop.
+ *
+ * @return false if the RREP offers no improvement over the known route.
+ */
+static bool _rrep_route_targ(aodvv2_message_t *msg, uint8_t link_cost)
 {
-    (void)cont;
+    /* for every relevant address (RteMsg.Addr) in the RteMsg, HandlingRtr
+    searches its route table to see if there is a route table entry with the
+    same MetricType of the RteMsg, matching RteMsg.Addr. */
+
+    aodvv2_local_route_t *rt_entry =
+        aodvv2_lrs_get_entry(&msg->targ_node.addr, msg->metric_type);
+
+    if (!rt_entry || (rt_entry->metric_type != msg->metric_type)) {
+        DEBUG_PUTS("aodvv2: creating new Local Route");
+
+        aodvv2_local_route_t tmp = {0};
+        aodvv2_lrs_fill_routing_entry_rrep(msg, &tmp);
+        aodvv2_lrs_add_entry(&tmp);
 
+        /* Add entry to NIB forwarding table */
+        aodvv2_route_update(&msg->targ_node.addr, msg->targ_node.pfx_len,
+                            &msg->sender, aodvv2_timers_route_lifetime());
+        return true;
+    }
+
+    if (!aodvv2_lrs_offers_improvement(rt_entry, &msg->targ_node)) {
+        DEBUG_PUTS("aodvv2: RREP offers no improvement over known route");
+        aodvv2_lrs_add_alternate(rt_entry, &msg->targ_node, &msg->sender,
+                                 link_cost);
+        return false;
+    }
+
+    /* The incoming routing information is better than existing routing
+     * table information and SHOULD be used to improve the route table. */
+    DEBUG_PUTS("aodvv2: updating Routing Table entry");
+    aodvv2_lrs_fill_routing_entry_rrep(msg, rt_entry);
+
+    /* Replace entry on NIB forwarding table */
+    aodvv2_route_update(&rt_entry->addr, rt_entry->pfx_len,
+                        &rt_entry->next_hop, aodvv2_timers_route_lifetime());
+    return true;
+}
+
+static bool _rrep_route(aodvv2_reader_ctx_t *ctx, const node_data_t *targ,
+                        uint8_t link_cost)
+{
+    /* The Local Route Set helpers take the TargNode from the message, it's
+     * swapped in instead of copying the whole message */
+    node_data_t saved = ctx->msg.targ_node;
+    ctx->msg.targ_node = *targ;
+
+    bool res = _rrep_route_targ(&ctx->msg, link_cost);
+
+    ctx->msg.targ_node = saved;
+    return res;
+}
+
+static enum rfc5444_result _rrep_end(aodvv2_reader_ctx_t *ctx, bool dropped)
+{
     /* Check if packet contains the required information */
     if (dropped) {
         DEBUG_PUTS("aodvv2: dropping packet");
         return RFC5444_DROP_PACKET;
     }
 
-    if (ipv6_addr_is_unspecified(&_msg_data.orig_node.addr) ||
-        _msg_data.orig_node.seqnum == 0) {
+    if (ipv6_addr_is_unspecified(&ctx->msg.orig_node.addr) ||
+        ctx->msg.orig_node.seqnum == 0) {
         DEBUG_PUTS("aodvv2: missing OrigNode Address or SeqNum");
         return RFC5444_DROP_PACKET;
     }
 
-    if (ipv6_addr_is_unspecified(&_msg_data.targ_node.addr) ||
-        _msg_data.targ_node.seqnum == 0) {
+    if (ipv6_addr_is_unspecified(&ctx->msg.targ_node.addr) ||
+        ctx->msg.targ_node.seqnum == 0) {
         DEBUG_PUTS("aodvv2: missing TargNode Address or SeqNum");
         return RFC5444_DROP_PACKET;
     }
 
-    uint8_t link_cost = aodvv2_metric_link_cost(_msg_data.metric_type);
+    uint8_t link_cost = aodvv2_metric_link_cost(ctx->msg.metric_type,
+                                                &ctx->msg.sender);
 
-    if ((aodvv2_metric_max(_msg_data.metric_type) - link_cost) <=
-        _msg_data.targ_node.metric) {
+    if ((aodvv2_metric_max(ctx->msg.metric_type) - link_cost) <=
+        ctx->msg.targ_node.metric) {
         DEBUG_PUTS("aodvv2: metric limit reached");
         return RFC5444_DROP_PACKET;
     }
 
-    aodvv2_metric_update(_msg_data.metric_type, &_msg_data.targ_node.metric);
+    aodvv2_metric_update(ctx->msg.metric_type, link_cost,
+                         &ctx->msg.targ_node.metric);
 
     /* Update packet timestamp */
     timex_t now;
     xtimer_now_timex(&now);
-    _msg_data.timestamp = now;
+    ctx->msg.timestamp = now;
 
-    /* for every relevant address (RteMsg.Addr) in the RteMsg, HandlingRtr
-    searches its route table to see if there is a route table entry with the
-    same MetricType of the RteMsg, matching RteMsg.Addr. */
-
-    aodvv2_local_route_t *rt_entry =
-        aodvv2_lrs_get_entry(&_msg_data.targ_node.addr, _msg_data.metric_type);
-
-    if (!rt_entry || (rt_entry->metric_type != _msg_data.metric_type)) {
-        DEBUG_PUTS("aodvv2: creating new Local Route");
+    /* A RREP that goes no further can still teach us routes to the other
+     * clients of the TargRouter */
+    bool handle = _rrep_route(ctx, &ctx->msg.targ_node, link_cost);
+    if (!handle && !IS_ACTIVE(CONFIG_AODVV2_PASSIVE_LEARNING)) {
+        return RFC5444_DROP_PACKET;
+    }
 
-        aodvv2_local_route_t tmp = {0};
-        aodvv2_lrs_fill_routing_entry_rrep(&_msg_data, &tmp, link_cost);
-        aodvv2_lrs_add_entry(&tmp);
+    /* Routes to the other clients of the TargRouter, the ones that can't
+     * go any further are left out when passing the RREP on */
+    unsigned num_targs = 0;
+    for (unsigned i = 0; i < ctx->msg.num_extra_targs; i++) {
+        node_data_t *targ = &ctx->msg.extra_targs[i];
 
-        /* Add entry to NIB forwarding table */
-        DEBUG_PUTS("aodvv2: adding Local Route to NIB FT");
-        if (gnrc_ipv6_nib_ft_add(&_msg_data.targ_node.addr,
-                                 _msg_data.targ_node.pfx_len, &_msg_data.sender,
-                                 _netif_pid, AODVV2_ROUTE_LIFETIME) < 0) {
-            DEBUG_PUTS("aodvv2: couldn't add route");
-        }
-    }
-    else {
-        if (!aodvv2_lrs_offers_improvement(rt_entry, &_msg_data.targ_node)) {
-            DEBUG_PUTS("aodvv2: RREP offers no improvement over known route");
-            return RFC5444_DROP_PACKET;
+        if ((aodvv2_metric_max(ctx->msg.metric_type) - link_cost) <=
+            targ->metric) {
+            DEBUG_PUTS("aodvv2: metric limit reached for client prefix");
+            continue;
         }
 
-        /* The incoming routing information is better than existing routing
-         * table information and SHOULD be used to improve the route table. */
-        DEBUG_PUTS("aodvv2: updating Routing Table entry");
-        aodvv2_lrs_fill_routing_entry_rrep(&_msg_data, rt_entry, link_cost);
-
-        /* Add entry to nib forwarding table */
-        gnrc_ipv6_nib_ft_del(&rt_entry->addr, rt_entry->pfx_len);
+        aodvv2_metric_update(ctx->msg.metric_type, link_cost, &targ->metric);
+        _rrep_route(ctx, targ, link_cost);
+        ctx->msg.extra_targs[num_targs++] = *targ;
+    }
+    ctx->msg.num_extra_targs = num_targs;
 
-        DEBUG_PUTS("aodvv2: adding route to NIB FT");
-        if (gnrc_ipv6_nib_ft_add(&rt_entry->addr, rt_entry->pfx_len,
-                                 &rt_entry->next_hop, _netif_pid,
-                                 AODVV2_ROUTE_LIFETIME) < 0) {
-            DEBUG_PUTS("aodvv2: couldn't add route");
-        }
+    if (!handle) {
+        return RFC5444_DROP_PACKET;
     }
 
-    if (aodvv2_rcs_is_client(&_msg_data.orig_node.addr) != NULL) {
+    /* Route repairs are originated with one of our own addresses */
+    if (aodvv2_rcs_is_client(&ctx->msg.orig_node.addr) != NULL ||
+        aodvv2_is_local_addr(&ctx->msg.orig_node.addr)) {
         DEBUG("aodvv2: {%" PRIu32 ":%" PRIu32 "}\n",
               now.seconds, now.microseconds);
         DEBUG("aodvv2: this is my RREP (SeqNum: %d)\n",
-              _msg_data.orig_node.seqnum);
+              ctx->msg.orig_node.seqnum);
         DEBUG_PUTS("aodvv2: We are done here, thanks!");
+        aodvv2_timers_discovery_done(&ctx->msg.targ_node.addr,
+                                     ctx->msg.targ_node.pfx_len);
 
         /* Send buffered packets for this address */
-        aodvv2_buffer_dispatch(&_msg_data.targ_node.addr);
+        aodvv2_buffer_dispatch(&ctx->msg.targ_node.addr);
+        for (unsigned i = 0; i < ctx->msg.num_extra_targs; i++) {
+            aodvv2_buffer_dispatch(&ctx->msg.extra_targs[i].addr);
+        }
     }
     else {
         DEBUG_PUTS("aodvv2: not my RREP, passing it on to the next hop.");
 
         ipv6_addr_t *next_hop =
-            aodvv2_lrs_get_next_hop(&_msg_data.orig_node.addr,
-                                    _msg_data.metric_type);
-        aodvv2_send_rrep(&_msg_data, next_hop);
+            aodvv2_lrs_get_next_hop(&ctx->msg.orig_node.addr,
+                                    ctx->msg.metric_type);
+        aodvv2_send_rrep(&ctx->msg, next_hop);
     }
     return RFC5444_OKAY;
 }
 
-static enum rfc5444_result _cb_rreq_blocktlv_messagetlvs_okay(
-        struct rfc5444_reader_tlvblock_context *cont)
+static enum rfc5444_result _rreq_addr(aodvv2_reader_ctx_t *ctx,
+                                       const struct netaddr *addr)
 {
-    if (!cont->has_hoplimit) {
-        DEBUG("aodvv2: missing hop limit\n");
-        return RFC5444_DROP_PACKET;
-    }
-
-    _msg_data.msg_hop_limit = cont->hoplimit;
-    if (_msg_data.msg_hop_limit == 0) {
-        DEBUG("aodvv2: Hoplimit is 0.\n");
-        return RFC5444_DROP_PACKET;
-    }
-    _msg_data.msg_hop_limit--;
-
-    return RFC5444_OKAY;
-}
-
-static enum rfc5444_result _cb_rreq_blocktlv_addresstlvs_okay(
-        struct rfc5444_reader_tlvblock_context *cont)
-{
-    struct rfc5444_reader_tlvblock_entry *tlv;
+    const aodvv2_reader_tlv_t *tlv;
     bool is_orig_node_addr = false;
     bool is_targ_node = false;
 
-    DEBUG("aodvv2: %s\n", netaddr_to_string(&nbuf, &cont->addr));
+#if ENABLE_DEBUG == 1
+    struct netaddr_str nbuf;
+    DEBUG("aodvv2: %s\n", netaddr_to_string(&nbuf, addr));
+#endif
 
     /* handle OrigNode SeqNum TLV */
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_ORIGSEQNUM].tlv;
-    if (tlv) {
-        DEBUG("aodvv2: RFC5444_MSGTLV_ORIGSEQNUM: %d\n", *tlv->single_value);
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_ORIGSEQNUM];
+    if (tlv->value != NULL) {
+        DEBUG("aodvv2: RFC5444_MSGTLV_ORIGSEQNUM: %d\n", *tlv->value);
         is_orig_node_addr = true;
-        netaddr_to_ipv6_addr(&cont->addr, &_msg_data.orig_node.addr,
-                             &_msg_data.orig_node.pfx_len);
-        _msg_data.orig_node.seqnum = *tlv->single_value;
+        netaddr_to_ipv6_addr(addr, &ctx->msg.orig_node.addr,
+                             &ctx->msg.orig_node.pfx_len);
+        ctx->msg.orig_node.seqnum = *tlv->value;
     }
 
-    /* handle TargNode SeqNum TLV */
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_TARGSEQNUM].tlv;
-    if (tlv) {
-        DEBUG("aodvv2: RFC5444_MSGTLV_TARGSEQNUM: %d\n", *tlv->single_value);
+    /* handle TargNode SeqNum TLV, assume that tlv missing => targ_node
+     * Address */
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_TARGSEQNUM];
+    if (tlv->value != NULL || !is_orig_node_addr) {
+        if (tlv->value != NULL) {
+            DEBUG("aodvv2: RFC5444_MSGTLV_TARGSEQNUM: %d\n", *tlv->value);
+        }
 
-        is_targ_node = true;
-        netaddr_to_ipv6_addr(&cont->addr, &_msg_data.targ_node.addr,
-                             &_msg_data.targ_node.pfx_len);
-        _msg_data.targ_node.seqnum = *tlv->single_value;
-    }
+        node_data_t *targ = _targ_next(ctx);
+        if (targ == NULL) {
+            return RFC5444_DROP_PACKET;
+        }
 
-    if (!tlv && !is_orig_node_addr) {
-        /* assume that tlv missing => targ_node Address */
         is_targ_node = true;
-        netaddr_to_ipv6_addr(&cont->addr, &_msg_data.targ_node.addr,
-                             &_msg_data.targ_node.pfx_len);
+        netaddr_to_ipv6_addr(addr, &targ->addr, &targ->pfx_len);
+        if (tlv->value != NULL) {
+            targ->seqnum = *tlv->value;
+        }
     }
 
     if (!is_orig_node_addr && !is_targ_node) {
@@ -352,173 +481,523 @@ static enum rfc5444_result _cb_rreq_blocktlv_addresstlvs_okay(
     }
 
     /* handle Metric TLV */
-    /* cppcheck: suppress false positive on non-trivially initialized arrays.
-     *           this is a known bug: http://trac.cppcheck.net/ticket/5497 */
-    /* cppcheck-suppress arrayIndexOutOfBounds */
-    tlv = _address_consumer_entries[RFC5444_MSGTLV_METRIC].tlv;
-    if (!tlv && is_orig_node_addr) {
+    tlv = &ctx->tlvs[RFC5444_MSGTLV_METRIC];
+    if (tlv->value == NULL && is_orig_node_addr) {
         DEBUG_PUTS("aodvv2: missing or unknown metric TLV");
         return RFC5444_DROP_PACKET;
     }
 
-    if (tlv) {
+    if (tlv->value != NULL) {
         if (!is_orig_node_addr) {
             DEBUG_PUTS("aodvv2: metric TLV belongs to wrong address");
             return RFC5444_DROP_PACKET;
         }
         DEBUG("aodvv2: RFC5444_MSGTLV_METRIC val: %d, exttype: %d\n",
-               *tlv->single_value, tlv->type_ext);
+               *tlv->value, tlv->type_ext);
 
-        _msg_data.metric_type = tlv->type_ext;
-        _msg_data.orig_node.metric = *tlv->single_value;
+        ctx->msg.metric_type = tlv->type_ext;
+        ctx->msg.orig_node.metric = *tlv->value;
+
+        /* Remember where to patch the metric when forwarding */
+        ctx->orig_metric = tlv->length == 1 ? tlv->value : NULL;
     }
     return RFC5444_OKAY;
 }
 
-static enum rfc5444_result _cb_rreq_end_callback(
-    struct rfc5444_reader_tlvblock_context *cont, bool dropped)
+/**
+ * @brief   Add or improve the route to the OrigNode of a RREQ
+ *
+ * A RREQ that offers no improvement may still give an alternate next hop.
+ *
+ * @return false if the RREQ offers no improvement over the known route.
+ */
+static bool _rreq_route(aodvv2_reader_ctx_t *ctx, uint8_t link_cost)
 {
-    (void) cont;
+    /* For every relevant address (RteMsg.Addr) in the RteMsg, HandlingRtr
+     * searches its route table to see if there is a route table entry with the
+     * same MetricType of the RteMsg, matching RteMsg.Addr.
+     */
+    aodvv2_local_route_t *rt_entry =
+        aodvv2_lrs_get_entry(&ctx->msg.orig_node.addr,
+                             ctx->msg.metric_type);
+
+    if (!rt_entry || (rt_entry->metric_type != ctx->msg.metric_type)) {
+        DEBUG_PUTS("aodvv2: creating new Local Route");
+
+        aodvv2_local_route_t tmp = {0};
 
+        /* Add this RREQ to LRS */
+        aodvv2_lrs_fill_routing_entry_rreq(&ctx->msg, &tmp);
+        aodvv2_lrs_add_entry(&tmp);
+
+        /* Add entry to NIB forwarding table */
+        aodvv2_route_update(&ctx->msg.orig_node.addr,
+                            ctx->msg.orig_node.pfx_len, &ctx->msg.sender,
+                            aodvv2_timers_route_lifetime());
+        return true;
+    }
+
+    /* If the route is already stored verify if this route offers an
+     * improvement in path*/
+    if (!aodvv2_lrs_offers_improvement(rt_entry, &ctx->msg.orig_node)) {
+        DEBUG_PUTS("aodvv2: packet offers no improvement over known route");
+        aodvv2_lrs_add_alternate(rt_entry, &ctx->msg.orig_node,
+                                 &ctx->msg.sender, link_cost);
+        return false;
+    }
+
+    /* The incoming routing information is better than existing routing
+     * table information and SHOULD be used to improve the route table. */
+    DEBUG_PUTS("aodvv2: updating Local Route");
+    aodvv2_lrs_fill_routing_entry_rreq(&ctx->msg, rt_entry);
+
+    /* Replace entry on NIB forwarding table */
+    aodvv2_route_update(&rt_entry->addr, rt_entry->pfx_len,
+                        &rt_entry->next_hop, aodvv2_timers_route_lifetime());
+    return true;
+}
 
+/**
+ * @brief   Get where to forward a RREQ
+ *
+ * A RREQ for a single TargNode we have an Active route to is sent along
+ * that route instead of flooding it, the RREP of TargNode is still the one
+ * that completes the discovery.
+ */
+static const ipv6_addr_t *_rreq_next_hop(aodvv2_reader_ctx_t *ctx,
+                                         aodvv2_message_t *fwd)
+{
+    if (fwd->num_extra_targs > 0) {
+        return &ipv6_addr_all_manet_routers_link_local;
+    }
+
+    aodvv2_local_route_t *rt_entry =
+        aodvv2_lrs_get_entry(&fwd->targ_node.addr, fwd->metric_type);
+
+    /* Never send it back where it came from */
+    if (rt_entry == NULL || rt_entry->state != ROUTE_STATE_ACTIVE ||
+        ipv6_addr_equal(&rt_entry->next_hop, &ctx->msg.sender)) {
+        return &ipv6_addr_all_manet_routers_link_local;
+    }
+
+    DEBUG_PUTS("aodvv2: TargNode route is Active, directing RREQ");
+    return &rt_entry->next_hop;
+}
+
+/**
+ * @brief   Advertise our other clients on a RREP we generate
+ */
+static void _rrep_add_clients(aodvv2_message_t *rrep)
+{
+    aodvv2_rcs_entry_t clients[CONFIG_AODVV2_RCS_ENTRIES];
+    unsigned num = aodvv2_rcs_get_entries(clients, ARRAY_SIZE(clients));
+
+    rrep->num_extra_targs = 0;
+    for (unsigned i = 0; i < num &&
+         rrep->num_extra_targs < ARRAY_SIZE(rrep->extra_targs); i++) {
+        if (clients[i].pfx_len == rrep->targ_node.pfx_len &&
+            ipv6_addr_equal(&clients[i].addr, &rrep->targ_node.addr)) {
+            continue;
+        }
+
+        node_data_t *targ = &rrep->extra_targs[rrep->num_extra_targs++];
+        memset(targ, 0, sizeof(*targ));
+        targ->addr = clients[i].addr;
+        targ->pfx_len = clients[i].pfx_len;
+    }
+}
+
+static enum rfc5444_result _rreq_end(aodvv2_reader_ctx_t *ctx, bool dropped)
+{
     /* Check if packet contains the required information */
     if (dropped) {
         DEBUG_PUTS("aodvv2: dropping packet");
         return RFC5444_DROP_PACKET;
     }
 
-    if (ipv6_addr_is_unspecified(&_msg_data.orig_node.addr) ||
-        _msg_data.orig_node.seqnum == 0) {
+    if (ipv6_addr_is_unspecified(&ctx->msg.orig_node.addr) ||
+        ctx->msg.orig_node.seqnum == 0) {
         DEBUG_PUTS("aodvv2: missing OrigNode Address or SeqNum");
         return RFC5444_DROP_PACKET;
     }
 
-    if (ipv6_addr_is_unspecified(&_msg_data.targ_node.addr)) {
+    if (ipv6_addr_is_unspecified(&ctx->msg.targ_node.addr)) {
         DEBUG_PUTS("aodvv2: missing TargNode Address");
         return RFC5444_DROP_PACKET;
     }
 
-    if (_msg_data.msg_hop_limit == 0) {
-        DEBUG_PUTS("aodvv2: hop limit is 0");
+    /* The RREP would have to go back over a link that doesn't work */
+    if (aodvv2_neigh_is_blacklisted(&ctx->msg.sender)) {
+        DEBUG_PUTS("aodvv2: sender is blacklisted, dropping RREQ");
         return RFC5444_DROP_PACKET;
     }
 
-    uint8_t link_cost = aodvv2_metric_link_cost(_msg_data.metric_type);
-    if ((aodvv2_metric_max(_msg_data.metric_type) - link_cost) <=
-        _msg_data.orig_node.metric) {
+    /* RREQs that go no further can still teach us a route to OrigNode */
+    bool handle = true;
+
+    if (ctx->msg.msg_hop_limit == 0) {
+        DEBUG_PUTS("aodvv2: hop limit is 0");
+        if (!IS_ACTIVE(CONFIG_AODVV2_PASSIVE_LEARNING)) {
+            return RFC5444_DROP_PACKET;
+        }
+        handle = false;
+    }
+
+    uint8_t link_cost = aodvv2_metric_link_cost(ctx->msg.metric_type,
+                                                &ctx->msg.sender);
+    if ((aodvv2_metric_max(ctx->msg.metric_type) - link_cost) <=
+        ctx->msg.orig_node.metric) {
         DEBUG_PUTS("aodvv2: metric limit reached");
         return RFC5444_DROP_PACKET;
     }
 
     /* The incoming RREQ MUST be checked against previously received information */
-    if (aodvv2_mcmsg_process(&_msg_data) == AODVV2_MCMSG_REDUNDANT) {
+    if (handle &&
+        aodvv2_mcmsg_process(&ctx->msg) == AODVV2_MCMSG_REDUNDANT) {
         DEBUG_PUTS("aodvv2: packet is redundant");
+        if (!IS_ACTIVE(CONFIG_AODVV2_PASSIVE_LEARNING) &&
+            !IS_ACTIVE(CONFIG_AODVV2_MULTIPATH)) {
+            return RFC5444_DROP_PACKET;
+        }
+        handle = false;
+    }
+
+    /* Our own RREQs coming back don't tell anything about our clients */
+    if (!handle && (aodvv2_rcs_is_client(&ctx->msg.orig_node.addr) != NULL ||
+                    aodvv2_is_local_addr(&ctx->msg.orig_node.addr))) {
         return RFC5444_DROP_PACKET;
     }
 
-    aodvv2_metric_update(_msg_data.metric_type, &_msg_data.orig_node.metric);
+    aodvv2_metric_update(ctx->msg.metric_type, link_cost,
+                         &ctx->msg.orig_node.metric);
 
     /* Update packet timestamp */
     timex_t now;
     xtimer_now_timex(&now);
-    _msg_data.timestamp = now;
+    ctx->msg.timestamp = now;
+
+    /* A redundant RREQ can still offer an alternate next hop */
+    if (!handle && !IS_ACTIVE(CONFIG_AODVV2_PASSIVE_LEARNING)) {
+        aodvv2_local_route_t *rt_entry =
+            aodvv2_lrs_get_entry(&ctx->msg.orig_node.addr,
+                                 ctx->msg.metric_type);
+        if (rt_entry != NULL) {
+            aodvv2_lrs_add_alternate(rt_entry, &ctx->msg.orig_node,
+                                     &ctx->msg.sender, link_cost);
+        }
+        return RFC5444_DROP_PACKET;
+    }
 
-    /* For every relevant address (RteMsg.Addr) in the RteMsg, HandlingRtr
-     * searches its route table to see if there is a route table entry with the
-     * same MetricType of the RteMsg, matching RteMsg.Addr.
+    if (!_rreq_route(ctx, link_cost) || !handle) {
+        return RFC5444_DROP_PACKET;
+    }
+
+    /* If TargNode is a client of the router receiving the RREQ, then the
+     * router generates a RREP message as specified in Section 7.4, and
+     * subsequently processing for the RREQ is complete.  Otherwise,
+     * processing continues as follows.
+     *
+     * A multi-target RREQ is answered for each TargNode that is a client
+     * and forwarded with the remaining ones. The RREPs are built on the
+     * received message itself, its TargNodes are set aside meanwhile.
      */
-    aodvv2_local_route_t *rt_entry =
-        aodvv2_lrs_get_entry(&_msg_data.orig_node.addr,
-                             _msg_data.metric_type);
+    node_data_t targs[CONFIG_AODVV2_RREQ_MAX_TARGETS];
+    unsigned num_all = ctx->msg.num_extra_targs + 1U;
+    unsigned num_targs = 0;
+
+    targs[0] = ctx->msg.targ_node;
+    memcpy(&targs[1], ctx->msg.extra_targs,
+           ctx->msg.num_extra_targs * sizeof(node_data_t));
+
+    for (unsigned i = 0; i < num_all; i++) {
+        if (aodvv2_rcs_is_client(&targs[i].addr) == NULL) {
+            targs[num_targs++] = targs[i];
+            continue;
+        }
 
-    if (!rt_entry || (rt_entry->metric_type != _msg_data.metric_type)) {
-        DEBUG_PUTS("aodvv2: creating new Local Route");
+        DEBUG_PUTS("aodvv2: TargNode is on client list, sending RREP");
 
-        aodvv2_local_route_t tmp = {0};
+        ctx->msg.targ_node = targs[i];
+        ctx->msg.num_extra_targs = 0;
 
-        /* Add this RREQ to LRS */
-        aodvv2_lrs_fill_routing_entry_rreq(&_msg_data, &tmp, link_cost);
-        aodvv2_lrs_add_entry(&tmp);
+        /* Make sure to start with a clean metric value */
+        ctx->msg.targ_node.metric = 0;
 
-        /* Add entry to NIB forwarding table */
-        DEBUG_PUTS("aodvv2: adding route to NIB FT");
-        if (gnrc_ipv6_nib_ft_add(&_msg_data.orig_node.addr,
-                                 _msg_data.orig_node.pfx_len, &_msg_data.sender,
-                                 _netif_pid, AODVV2_ROUTE_LIFETIME) < 0) {
-            DEBUG_PUTS("aodvv2: couldn't add route");
+        if (IS_ACTIVE(CONFIG_AODVV2_RREP_ADVERTISE_CLIENTS)) {
+            _rrep_add_clients(&ctx->msg);
         }
-    }
-    else {
-        /* If the route is already stored verify if this route offers an
-         * improvement in path*/
-        if (!aodvv2_lrs_offers_improvement(rt_entry, &_msg_data.orig_node)) {
-            DEBUG_PUTS("aodvv2: packet offers no improvement over known route");
-            return RFC5444_DROP_PACKET;
+
+        aodvv2_send_rrep(&ctx->msg, &ctx->msg.sender);
+
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+        /* The packet the originator didn't buffer, delivered once */
+        if (ctx->data_len > 0 &&
+            aodvv2_rreq_data_deliver(ctx->data, ctx->data_len,
+                                     &ctx->msg.targ_node) == 0) {
+            ctx->data_len = 0;
         }
+#endif
+    }
 
-        /* The incoming routing information is better than existing routing
-         * table information and SHOULD be used to improve the route table. */
-        DEBUG_PUTS("aodvv2: updating Local Route");
-        aodvv2_lrs_fill_routing_entry_rreq(&_msg_data, rt_entry, link_cost);
+    if (num_targs == 0) {
+        return RFC5444_OKAY;
+    }
 
-        /* Add entry to nib forwarding table */
-        gnrc_ipv6_nib_ft_del(&rt_entry->addr, rt_entry->pfx_len);
+    /* Forwarded with the TargNodes that aren't our clients */
+    ctx->msg.targ_node = targs[0];
+    ctx->msg.num_extra_targs = num_targs - 1;
+    memcpy(ctx->msg.extra_targs, &targs[1],
+           ctx->msg.num_extra_targs * sizeof(node_data_t));
 
-        DEBUG_PUTS("aodvv2: adding route to NIB FT");
-        if (gnrc_ipv6_nib_ft_add(&rt_entry->addr, rt_entry->pfx_len,
-                                 &rt_entry->next_hop, _netif_pid,
-                                 AODVV2_ROUTE_LIFETIME) < 0) {
-            DEBUG_PUTS("aodvv2: couldn't add route");
-        }
+    /* Routes go around a node about to run out of battery */
+    if (IS_ACTIVE(CONFIG_AODVV2_ENERGY_CRITICAL_NO_FORWARD) &&
+        aodvv2_energy_is_critical()) {
+        DEBUG_PUTS("aodvv2: battery critically low, not forwarding RREQ");
+        return RFC5444_OKAY;
     }
 
-    /* If TargNode is a client of the router receiving the RREQ, then the
-     * router generates a RREP message as specified in Section 7.4, and
-     * subsequently processing for the RREQ is complete.  Otherwise,
-     * processing continues as follows.
-     */
-    if (aodvv2_rcs_is_client(&_msg_data.targ_node.addr) != NULL) {
-        DEBUG_PUTS("aodvv2: TargNode is on client list, sending RREP");
+    DEBUG_PUTS("aodvv2: I'm not TargNode, forwarding RREQ");
 
-        /* Make sure to start with a clean metric value */
-        _msg_data.targ_node.metric = 0;
+    /* The received message can only be copied if it still has all the
+     * TargPrefixes */
+    const uint8_t *metric = NULL;
+    if (num_targs == num_all) {
+        metric = ctx->orig_metric;
+    }
 
-        aodvv2_send_rrep(&_msg_data, &_msg_data.sender);
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    /* Encoding the RREQ again needs the packet once the received one is
+     * gone, without a free entry it's forwarded without it */
+    ctx->msg.data = aodvv2_rreq_data_alloc(ctx->data_len);
+    if (ctx->msg.data != 0) {
+        memcpy(aodvv2_rreq_data_get(ctx->msg.data)->data, ctx->data,
+               ctx->data_len);
     }
-    else {
-        DEBUG_PUTS("aodvv2: I'm not TargNode, forwarding RREQ");
-        aodvv2_send_rreq(&_msg_data, &ipv6_addr_all_manet_routers_link_local);
+#endif
+
+    aodvv2_forward_rreq(&ctx->msg, _rreq_next_hop(ctx, &ctx->msg),
+                        ctx->msg_buffer, ctx->msg_size, metric);
+
+    return RFC5444_OKAY;
+}
+
+/**
+ * @brief   Take the link status and delivery ratio a HELLO lists for us
+ */
+static enum rfc5444_result _hello_addr(aodvv2_reader_ctx_t *ctx,
+                                       const struct netaddr *addr)
+{
+    /* Addresses without LINK_STATUS are the neighbors of its neighbors */
+    if (ctx->hello.status != RFC6130_LINKSTATUS_HEARD &&
+        ctx->hello.status != RFC6130_LINKSTATUS_SYMMETRIC) {
+        return RFC5444_OKAY;
+    }
+
+    ipv6_addr_t tmp;
+    uint8_t pfx_len;
+    netaddr_to_ipv6_addr(addr, &tmp, &pfx_len);
+
+    if (aodvv2_is_local_addr(&tmp)) {
+        ctx->hello.listed = true;
+        ctx->hello.our_ratio = ctx->hello.ratio;
     }
 
     return RFC5444_OKAY;
 }
 
-void aodvv2_reader_init(struct rfc5444_reader *reader, kernel_pid_t netif_pid)
+static enum rfc5444_result _hello_end(aodvv2_reader_ctx_t *ctx,
+                                      bool has_seqno, uint16_t seqno,
+                                      bool dropped)
 {
-    assert(reader != NULL && netif_pid != KERNEL_PID_UNDEF);
+    if (dropped || !has_seqno || ctx->hello.validity == 0) {
+        DEBUG_PUTS("aodvv2: dropping HELLO");
+        return RFC5444_DROP_PACKET;
+    }
 
-    if (_netif_pid == KERNEL_PID_UNDEF) {
-        _netif_pid = netif_pid;
+    aodvv2_neigh_t *neigh = aodvv2_neigh_hello_rcvd(&ctx->sender, seqno,
+                                                    ctx->hello.validity,
+                                                    ctx->hello.listed);
+    if (ctx->hello.our_ratio != 0) {
+        neigh->fwd_ratio = ctx->hello.our_ratio;
     }
 
+    DEBUG("aodvv2: HELLO %u, %s, ratios %u/%u\n", (unsigned)seqno,
+          ctx->hello.listed ? "listed" : "not listed",
+          (unsigned)neigh->fwd_ratio, (unsigned)neigh->rev_ratio);
+
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_msg_start(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    _msg_start(_ctx(cont), cont->msg_buffer, cont->msg_size);
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_blocktlv_messagetlvs_okay(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    return _msg_hoplimit(_ctx(cont), cont->has_hoplimit, cont->hoplimit);
+}
+
+static enum rfc5444_result _cb_addr_start(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    memset(ctx->tlvs, 0, sizeof(ctx->tlvs));
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_addr_tlv(
+        struct rfc5444_reader_tlvblock_entry *entry,
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    aodvv2_reader_tlv_set(ctx->tlvs, entry->type, entry->type_ext,
+                          entry->single_value, entry->length);
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_rrep_blocktlv_addresstlvs_okay(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    return _rrep_addr(_ctx(cont), &cont->addr);
+}
+
+static enum rfc5444_result _cb_rrep_end_callback(
+        struct rfc5444_reader_tlvblock_context *cont, bool dropped)
+{
+    return _rrep_end(_ctx(cont), dropped);
+}
+
+static enum rfc5444_result _cb_rreq_msg_tlv(
+        struct rfc5444_reader_tlvblock_entry *entry,
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    /* Data that doesn't fit is left out, the RREQ is still good */
+    if (entry->type == RFC5444_MSGTLV_DATA && entry->length > 0) {
+        if (entry->length > CONFIG_AODVV2_RREQ_DATA_SIZE) {
+            DEBUG_PUTS("aodvv2: data on RREQ too large, ignoring it");
+            return RFC5444_OKAY;
+        }
+        ctx->data = entry->single_value;
+        ctx->data_len = entry->length;
+    }
+#else
+    (void)entry;
+    (void)cont;
+#endif
+
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_rreq_blocktlv_addresstlvs_okay(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    return _rreq_addr(_ctx(cont), &cont->addr);
+}
+
+static enum rfc5444_result _cb_rreq_end_callback(
+        struct rfc5444_reader_tlvblock_context *cont, bool dropped)
+{
+    return _rreq_end(_ctx(cont), dropped);
+}
+
+static enum rfc5444_result _cb_hello_msg_tlv(
+        struct rfc5444_reader_tlvblock_entry *entry,
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    /* Only a single value, not one per hop count */
+    if (entry->type == RFC5497_MSGTLV_VALIDITY_TIME && entry->length == 1) {
+        ctx->hello.validity = rfc5497_timetlv_decode(*entry->single_value);
+    }
+
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_hello_addr_start(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    ctx->hello.status = RFC6130_LINKSTATUS_LOST;
+    ctx->hello.ratio = 0;
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_hello_addr_tlv(
+        struct rfc5444_reader_tlvblock_entry *entry,
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    aodvv2_reader_ctx_t *ctx = _ctx(cont);
+
+    if (entry->length != 1) {
+        return RFC5444_OKAY;
+    }
+
+    if (entry->type == RFC6130_ADDRTLV_LINK_STATUS) {
+        ctx->hello.status = *entry->single_value;
+    }
+    else if (entry->type == RFC5444_ADDRTLV_DELIVERY_RATIO) {
+        ctx->hello.ratio = *entry->single_value;
+    }
+
+    return RFC5444_OKAY;
+}
+
+static enum rfc5444_result _cb_hello_blocktlv_addresstlvs_okay(
+        struct rfc5444_reader_tlvblock_context *cont)
+{
+    return _hello_addr(_ctx(cont), &cont->addr);
+}
+
+static enum rfc5444_result _cb_hello_end_callback(
+        struct rfc5444_reader_tlvblock_context *cont, bool dropped)
+{
+    return _hello_end(_ctx(cont), cont->has_seqno, cont->seqno, dropped);
+}
+
+void aodvv2_reader_init(struct rfc5444_reader *reader)
+{
+    assert(reader != NULL);
+
     rfc5444_reader_add_message_consumer(reader, &_rrep_consumer,
                                         NULL, 0);
 
     rfc5444_reader_add_message_consumer(reader, &_rrep_address_consumer,
-                                        _address_consumer_entries,
-                                        ARRAY_SIZE(_address_consumer_entries));
+                                        NULL, 0);
 
     rfc5444_reader_add_message_consumer(reader, &_rreq_consumer,
                                         NULL, 0);
 
     rfc5444_reader_add_message_consumer(reader, &_rreq_address_consumer,
-                                        _address_consumer_entries,
-                                        ARRAY_SIZE(_address_consumer_entries));
+                                        NULL, 0);
+
+    rfc5444_reader_add_message_consumer(reader, &_hello_consumer,
+                                        NULL, 0);
+
+    rfc5444_reader_add_message_consumer(reader, &_hello_address_consumer,
+                                        NULL, 0);
 }
 
-void aodvv2_rfc5444_handle_packet_prepare(ipv6_addr_t *sender)
+enum rfc5444_result aodvv2_reader_handle_packet(struct rfc5444_reader *reader,
+                                                const ipv6_addr_t *sender,
+                                                const uint8_t *buffer,
+                                                size_t length)
 {
-    assert(sender != NULL);
+    assert(reader != NULL && sender != NULL && buffer != NULL);
+
+    aodvv2_reader_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.sender = *sender;
 
-    _msg_data.sender = *sender;
+    return rfc5444_reader_handle_packet_ctx(reader, buffer, length, &ctx);
 }
@@ -28,21 +28,100 @@
 extern "C" {
 #endif
 
+/**
+ * @brief   Number of AODVv2 TLV types tracked per address
+ */
+#define AODVV2_READER_TLVS (RFC5444_MSGTLV_METRIC + 1)
+
+/**
+ * @brief   Value of an address TLV
+ */
+typedef struct {
+    const uint8_t *value;  /**< TLV value, NULL if the TLV isn't present */
+    uint16_t length;       /**< Length of @ref value */
+    uint8_t type_ext;      /**< TLV type extension */
+} aodvv2_reader_tlv_t;
+
+/**
+ * @brief   Per-packet AODVv2 parse context
+ *
+ * Carried through the RFC5444 reader as the user context of the packet, so
+ * no parsing state is shared between packets being handled at the same time.
+ */
+typedef struct {
+    ipv6_addr_t sender;    /**< Sender of the packet */
+    aodvv2_message_t msg;  /**< Message being parsed */
+    aodvv2_reader_tlv_t tlvs[AODVV2_READER_TLVS]; /**< TLVs of the current address */
+    const uint8_t *msg_buffer;  /**< Received message being parsed */
+    size_t msg_size;            /**< Length of @ref msg_buffer */
+    const uint8_t *orig_metric; /**< OrigNode metric value on @ref msg_buffer */
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK) || defined(DOXYGEN)
+    const uint8_t *data;        /**< Packet carried on the RREQ, on
+                                     @ref msg_buffer */
+    size_t data_len;            /**< Length of @ref data, 0 if none */
+#endif
+    struct {
+        uint32_t validity;      /**< VALIDITY_TIME in milliseconds, 0 if
+                                     missing */
+        uint8_t status;         /**< LINK_STATUS of the current address */
+        uint8_t ratio;          /**< Delivery ratio of the current address */
+        uint8_t our_ratio;      /**< Delivery ratio listed for us, 0 if none */
+        bool listed;            /**< Are we listed as heard or symmetric? */
+    } hello;                    /**< HELLO being parsed */
+} aodvv2_reader_ctx_t;
+
+/**
+ * @brief   Store a TLV of an address
+ *
+ * Unknown and empty TLVs are ignored. If the address carries several TLVs
+ * of the same type the one with the lowest type extension is kept, which is
+ * the first one the RFC5444 reader hands over.
+ *
+ * @param[in,out] tlvs     TLVs of the address.
+ * @param[in]     type     TLV type.
+ * @param[in]     type_ext TLV type extension.
+ * @param[in]     value    TLV value.
+ * @param[in]     length   Length of @p value.
+ */
+static inline void aodvv2_reader_tlv_set(aodvv2_reader_tlv_t *tlvs,
+                                         uint8_t type, uint8_t type_ext,
+                                         const uint8_t *value, uint16_t length)
+{
+    if (type >= AODVV2_READER_TLVS || value == NULL || length == 0) {
+        return;
+    }
+
+    if (tlvs[type].value == NULL || type_ext < tlvs[type].type_ext) {
+        tlvs[type].value = value;
+        tlvs[type].length = length;
+        tlvs[type].type_ext = type_ext;
+    }
+}
+
 /**
  * @brief   Register AODVv2 message reader
  *
  * @param[in] reader Pointer to the reader context.
  */
-void aodvv2_reader_init(struct rfc5444_reader *reader, kernel_pid_t netif_pid);
+void aodvv2_reader_init(struct rfc5444_reader *reader);
 
 /**
- * @brief   Sets the sender address
+ * @brief   Parse and handle an AODVv2 packet
  *
- * @notes MUST be called before starting to parse the packet.
+ * @notes Can be called concurrently for different packets, the parse state
+ *        lives on the caller's stack and the reader pools are locked.
  *
+ * @param[in] reader Pointer to the reader context.
  * @param[in] sender The address of the sender.
+ * @param[in] buffer The packet.
+ * @param[in] length Length of @p buffer.
+ *
+ * @return RFC5444_OKAY on success, RFC5444_... otherwise.
  */
-void aodvv2_rfc5444_handle_packet_prepare(ipv6_addr_t *sender);
+enum rfc5444_result aodvv2_reader_handle_packet(struct rfc5444_reader *reader,
+                                                const ipv6_addr_t *sender,
+                                                const uint8_t *buffer,
+                                                size_t length);
 
 #ifdef __cplusplus
 } /* extern "C" */
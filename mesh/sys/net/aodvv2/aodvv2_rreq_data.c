@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 packets carried on RREQs
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ * @}
+ */
+
+#include <assert.h>
+
+#include "kernel_defines.h"
+#include "mutex.h"
+
+#include "net/aodvv2/rreq_data.h"
+
+#if CONFIG_AODVV2_RREQ_DATA_NUMOF > UINT8_MAX
+#error "CONFIG_AODVV2_RREQ_DATA_NUMOF is too large"
+#endif
+
+/**
+ * @brief   Entries, taken by the threads starting route discoveries and
+ *          given back by the AODVv2 thread
+ */
+static aodvv2_rreq_data_t _entries[CONFIG_AODVV2_RREQ_DATA_NUMOF];
+static mutex_t _lock = MUTEX_INIT;
+
+uint8_t aodvv2_rreq_data_alloc(size_t len)
+{
+    if (len == 0 || len > CONFIG_AODVV2_RREQ_DATA_SIZE) {
+        return 0;
+    }
+
+    mutex_lock(&_lock);
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries); i++) {
+        if (_entries[i].len == 0) {
+            _entries[i].len = len;
+            mutex_unlock(&_lock);
+            return i + 1;
+        }
+    }
+    mutex_unlock(&_lock);
+
+    return 0;
+}
+
+aodvv2_rreq_data_t *aodvv2_rreq_data_get(uint8_t idx)
+{
+    assert(idx <= ARRAY_SIZE(_entries));
+
+    if (idx == 0) {
+        return NULL;
+    }
+
+    return &_entries[idx - 1];
+}
+
+void aodvv2_rreq_data_free(uint8_t idx)
+{
+    assert(idx <= ARRAY_SIZE(_entries));
+
+    if (idx == 0) {
+        return;
+    }
+
+    mutex_lock(&_lock);
+    _entries[idx - 1].len = 0;
+    mutex_unlock(&_lock);
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2021 btcven and Locha Mesh developers <contact@locha.io>
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_aodvv2
+ * @{
+ *
+ * @file
+ * @brief       AODVv2 adaptive protocol timers
+ *
+ * @author      Locha Mesh developers <contact@locha.io>
+ * @}
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "xtimer.h"
+
+#include "net/aodvv2/timers.h"
+
+#define ENABLE_DEBUG (0)
+#include "debug.h"
+
+#if CONFIG_AODVV2_TIMERS_MIN_PERCENT < 1 || \
+    CONFIG_AODVV2_TIMERS_MIN_PERCENT > 100
+#error "CONFIG_AODVV2_TIMERS_MIN_PERCENT must be between 1 and 100"
+#endif
+
+#if CONFIG_AODVV2_MAX_IDLETIME > UINT16_MAX || \
+    CONFIG_AODVV2_MAX_SEQNUM_LIFETIME > UINT16_MAX
+#error "CONFIG_AODVV2_MAX_IDLETIME and MAX_SEQNUM_LIFETIME are too large"
+#endif
+
+/**
+ * @brief   Timers and the counters of the current interval, accessed from
+ *          the AODVv2 thread and the threads starting route discoveries
+ */
+static aodvv2_timers_t _timers = {
+    .scale = 100,
+    .max_idletime = CONFIG_AODVV2_MAX_IDLETIME,
+    .max_seqnum_lifetime = CONFIG_AODVV2_MAX_SEQNUM_LIFETIME,
+};
+static mutex_t _lock = MUTEX_INIT;
+
+/**
+ * @brief   Route discovery being followed
+ */
+typedef struct {
+    ipv6_addr_t targ;       /**< TargNode of the RREQ */
+    timex_t deadline;       /**< End of RREQ_WAIT_TIME */
+    bool used;              /**< Is this entry used? */
+} discovery_t;
+
+static discovery_t _discoveries[CONFIG_AODVV2_TIMERS_DISCOVERIES];
+
+static uint16_t _scaled(uint32_t value, uint8_t scale)
+{
+    value = (value * scale) / 100;
+
+    if (value < 1) {
+        return 1;
+    }
+    return value;
+}
+
+static void _set_scale(uint8_t scale)
+{
+    _timers.scale = scale;
+    _timers.max_idletime = _scaled(CONFIG_AODVV2_MAX_IDLETIME, scale);
+    _timers.max_seqnum_lifetime = _scaled(CONFIG_AODVV2_MAX_SEQNUM_LIFETIME,
+                                          scale);
+}
+
+void aodvv2_timers_init(void)
+{
+    mutex_lock(&_lock);
+    memset(&_timers, 0, sizeof(_timers));
+    memset(_discoveries, 0, sizeof(_discoveries));
+    _set_scale(100);
+    mutex_unlock(&_lock);
+}
+
+void aodvv2_timers_adapt(void)
+{
+    if (!IS_ACTIVE(CONFIG_AODVV2_ADAPTIVE_TIMERS)) {
+        return;
+    }
+
+    mutex_lock(&_lock);
+
+    unsigned scale = _timers.scale;
+    bool failing = _timers.discoveries > 0 &&
+                   (_timers.discoveries_done * 2U) < _timers.discoveries;
+
+    if (_timers.breaks > 0 || failing) {
+        /* Routes don't last, halve the way to the minimum */
+        scale -= (scale - CONFIG_AODVV2_TIMERS_MIN_PERCENT + 1) / 2;
+    }
+    else {
+        scale += CONFIG_AODVV2_TIMERS_STEP_PERCENT;
+        if (scale > 100) {
+            scale = 100;
+        }
+    }
+
+    if (scale != _timers.scale) {
+        DEBUG("aodvv2: timers at %u%%, %u breaks, %u/%u discoveries\n",
+              scale, (unsigned)_timers.breaks,
+              (unsigned)_timers.discoveries_done,
+              (unsigned)_timers.discoveries);
+        _set_scale(scale);
+    }
+
+    _timers.breaks = 0;
+    _timers.discoveries = 0;
+    _timers.discoveries_done = 0;
+
+    mutex_unlock(&_lock);
+}
+
+static void _count(uint16_t *counter, unsigned num)
+{
+    unsigned left = UINT16_MAX - *counter;
+    *counter = num > left ? UINT16_MAX : *counter + num;
+}
+
+static bool _discovery_pending(const discovery_t *discovery, timex_t now)
+{
+    return discovery->used && timex_cmp(now, discovery->deadline) < 0;
+}
+
+void aodvv2_timers_routes_broken(unsigned num)
+{
+    mutex_lock(&_lock);
+    _count(&_timers.breaks, num);
+    mutex_unlock(&_lock);
+}
+
+void aodvv2_timers_discovery_started(const ipv6_addr_t *targ)
+{
+    assert(targ != NULL);
+
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    mutex_lock(&_lock);
+
+    /* Take a slot entry, or the one of the oldest discovery */
+    discovery_t *slot = &_discoveries[0];
+    for (unsigned i = 0; i < ARRAY_SIZE(_discoveries); i++) {
+        discovery_t *discovery = &_discoveries[i];
+
+        if (!_discovery_pending(discovery, now)) {
+            slot = discovery;
+            continue;
+        }
+
+        if (ipv6_addr_equal(&discovery->targ, targ)) {
+            DEBUG_PUTS("aodvv2: route discovery already followed");
+            mutex_unlock(&_lock);
+            return;
+        }
+
+        if (_discovery_pending(slot, now) &&
+            timex_cmp(discovery->deadline, slot->deadline) < 0) {
+            slot = discovery;
+        }
+    }
+
+    slot->targ = *targ;
+    slot->deadline = timex_add(now,
+                               timex_set(CONFIG_AODVV2_RREQ_WAIT_TIME, 0));
+    slot->used = true;
+    _count(&_timers.discoveries, 1);
+
+    mutex_unlock(&_lock);
+}
+
+void aodvv2_timers_discovery_done(const ipv6_addr_t *targ, uint8_t pfx_len)
+{
+    assert(targ != NULL);
+
+    timex_t now;
+    xtimer_now_timex(&now);
+
+    mutex_lock(&_lock);
+
+    /* Later RREPs, from another gateway or for another path, find the
+     * discovery completed */
+    for (unsigned i = 0; i < ARRAY_SIZE(_discoveries); i++) {
+        discovery_t *discovery = &_discoveries[i];
+
+        if (_discovery_pending(discovery, now) &&
+            ipv6_addr_match_prefix(&discovery->targ, targ) >= pfx_len) {
+            discovery->used = false;
+            _count(&_timers.discoveries_done, 1);
+            break;
+        }
+    }
+
+    mutex_unlock(&_lock);
+}
+
+uint16_t aodvv2_timers_route_lifetime(void)
+{
+    mutex_lock(&_lock);
+    uint32_t lifetime = (uint32_t)CONFIG_AODVV2_ACTIVE_INTERVAL +
+                        _timers.max_idletime;
+    mutex_unlock(&_lock);
+
+    return lifetime > UINT16_MAX ? UINT16_MAX : lifetime;
+}
+
+uint16_t aodvv2_timers_seqnum_lifetime(void)
+{
+    mutex_lock(&_lock);
+    uint16_t lifetime = _timers.max_seqnum_lifetime;
+    mutex_unlock(&_lock);
+
+    return lifetime;
+}
+
+void aodvv2_timers_get(aodvv2_timers_t *timers)
+{
+    assert(timers != NULL);
+
+    mutex_lock(&_lock);
+    *timers = _timers;
+    mutex_unlock(&_lock);
+}
@@ -20,8 +20,15 @@
  * @}
  */
 
+#include <assert.h>
+#include <errno.h>
+
 #include "aodvv2_writer.h"
 #include "net/aodvv2/metric.h"
+#include "net/aodvv2/rreq_data.h"
+
+#include "rfc5444/rfc5444.h"
+#include "rfc5444/rfc5444_context.h"
 
 #include "rfc5444_compat.h"
 
@@ -29,8 +36,12 @@
 #include "debug.h"
 
 static int _cb_add_message_header(struct rfc5444_writer *wr, struct rfc5444_writer_message *message);
+static void _cb_rreq_add_message_tlvs(struct rfc5444_writer *wr);
 static void _cb_rreq_add_addresses(struct rfc5444_writer *wr);
 static void _cb_rrep_add_addresses(struct rfc5444_writer *wr);
+static int _cb_hello_add_message_header(struct rfc5444_writer *wr, struct rfc5444_writer_message *message);
+static void _cb_hello_add_message_tlvs(struct rfc5444_writer *wr);
+static void _cb_hello_add_addresses(struct rfc5444_writer *wr);
 
 /*
  * message content provider that will add message TLVs,
@@ -39,6 +50,7 @@ static void _cb_rrep_add_addresses(struct rfc5444_writer *wr);
 static struct rfc5444_writer_content_provider _rreq_message_content_provider =
 {
     .msg_type = RFC5444_MSGTYPE_RREQ,
+    .addMessageTLVs = _cb_rreq_add_message_tlvs,
     .addAddresses = _cb_rreq_add_addresses,
 };
 
@@ -73,11 +85,78 @@ static struct rfc5444_writer_tlvtype _rrep_addrtlvs[] =
     },
 };
 
+/*
+ * message content provider that will add the interval and validity time,
+ * the neighbors, their link status and delivery ratios to all HELLOs.
+ */
+static struct rfc5444_writer_content_provider _hello_message_content_provider =
+{
+    .msg_type = RFC6130_MSGTYPE_HELLO,
+    .addMessageTLVs = _cb_hello_add_message_tlvs,
+    .addAddresses = _cb_hello_add_addresses,
+};
+
+/* declaration of all address TLVs added to the HELLO message */
+static struct rfc5444_writer_tlvtype _hello_addrtlvs[] =
+{
+    { .type = RFC6130_ADDRTLV_LINK_STATUS },
+    { .type = RFC5444_ADDRTLV_DELIVERY_RATIO },
+};
+
 static struct rfc5444_writer_message *_rreq_msg;
 static struct rfc5444_writer_message *_rrep_msg;
+static struct rfc5444_writer_message *_hello_msg;
 
 static aodvv2_message_t _msg;
 
+/**
+ * @brief   HELLO being written
+ */
+static struct {
+    unsigned start;               /**< First Neighbor Set state to list */
+    unsigned end;                 /**< State past the last neighbor listed */
+    unsigned max;                 /**< Maximum number of neighbors to list */
+    uint16_t seqnum;              /**< SeqNum of the HELLO */
+    uint8_t interval;             /**< Encoded INTERVAL_TIME */
+    uint8_t validity;             /**< Encoded VALIDITY_TIME */
+} _hello;
+
+/**
+ * @brief   Length of an IPv6 address in bytes
+ */
+#define AODVV2_WRITER_ADDR_LEN (16)
+
+/**
+ * @brief   Maximum size of a precompiled address TLV block
+ */
+#define AODVV2_WRITER_TEMPLATE_TLVS_SIZE (24)
+
+/**
+ * @brief   Maximum size of a message written from a template
+ *
+ * Message header, a single address block holding both addresses and the
+ * address TLV block.
+ */
+#define AODVV2_WRITER_TEMPLATE_MSG_SIZE \
+    (7 + 6 + (2 * AODVV2_WRITER_ADDR_LEN) + AODVV2_WRITER_TEMPLATE_TLVS_SIZE)
+
+/**
+ * @brief   Precompiled address TLV block of a message
+ *
+ * The TLVs are laid out exactly as the generic writer does for our
+ * messages, only the values have to be patched.
+ */
+typedef struct {
+    uint8_t tlvs[AODVV2_WRITER_TEMPLATE_TLVS_SIZE]; /**< TLV block */
+    uint8_t len;                                    /**< Length of @ref tlvs */
+    uint8_t orig_seqnum;                            /**< OrigSeqNum offset */
+    uint8_t targ_seqnum;                            /**< TargSeqNum offset */
+    uint8_t metric;                                 /**< Metric offset */
+} msg_template_t;
+
+static msg_template_t _rreq_template;
+static msg_template_t _rrep_template;
+
 static int _cb_add_message_header(struct rfc5444_writer *wr, struct rfc5444_writer_message *message)
 {
     /* no originator, no hopcount, has msg_hop_limit, no seqno */
@@ -87,6 +166,73 @@ static int _cb_add_message_header(struct rfc5444_writer *wr, struct rfc5444_writ
     return 0;
 }
 
+static int _cb_hello_add_message_header(struct rfc5444_writer *wr, struct rfc5444_writer_message *message)
+{
+    /* no originator, no hopcount, has msg_hop_limit, has seqno */
+    rfc5444_writer_set_msg_header(wr, message, false, false, true, true);
+    rfc5444_writer_set_msg_hoplimit(wr, message, 1);
+    rfc5444_writer_set_msg_seqno(wr, message, _hello.seqnum);
+
+    return 0;
+}
+
+static void _cb_hello_add_message_tlvs(struct rfc5444_writer *wr)
+{
+    rfc5444_writer_add_messagetlv(wr, RFC5497_MSGTLV_INTERVAL_TIME, 0,
+                                  &_hello.interval, sizeof(_hello.interval));
+    rfc5444_writer_add_messagetlv(wr, RFC5497_MSGTLV_VALIDITY_TIME, 0,
+                                  &_hello.validity, sizeof(_hello.validity));
+}
+
+static void _cb_hello_add_addresses(struct rfc5444_writer *wr)
+{
+    static const uint8_t heard = RFC6130_LINKSTATUS_HEARD;
+    static const uint8_t symmetric = RFC6130_LINKSTATUS_SYMMETRIC;
+    struct rfc5444_writer_address *addr;
+    struct netaddr tmp;
+
+    const aodvv2_neigh_t *neigh;
+    unsigned state = _hello.start;
+
+    for (unsigned i = 0; i < _hello.max &&
+         (neigh = aodvv2_neigh_hello_next(&state)) != NULL; i++) {
+        _hello.end = state;
+
+        ipv6_addr_to_netaddr(&neigh->addr, 128, &tmp);
+        addr = rfc5444_writer_add_address(wr, _hello_message_content_provider.creator, &tmp, false);
+        if (addr == NULL) {
+            DEBUG_PUTS("aodvv2: couldn't add neighbor to HELLO");
+            break;
+        }
+
+        /* We hear every neighbor we list */
+        const uint8_t *status = neigh->link == AODVV2_NEIGH_LINK_SYMMETRIC
+                                ? &symmetric : &heard;
+        rfc5444_writer_add_addrtlv(wr, addr, &_hello_addrtlvs[0], status,
+                                   sizeof(*status), false);
+
+        if (CONFIG_AODVV2_DEFAULT_METRIC == METRIC_LINK_ETX &&
+            neigh->rev_ratio != 0) {
+            rfc5444_writer_add_addrtlv(wr, addr, &_hello_addrtlvs[1], &neigh->rev_ratio,
+                                       sizeof(neigh->rev_ratio), false);
+        }
+    }
+}
+
+static void _cb_rreq_add_message_tlvs(struct rfc5444_writer *wr)
+{
+#if IS_ACTIVE(CONFIG_AODVV2_RREQ_PIGGYBACK)
+    const aodvv2_rreq_data_t *data = aodvv2_rreq_data_get(_msg.data);
+
+    if (data != NULL) {
+        rfc5444_writer_add_messagetlv(wr, RFC5444_MSGTLV_DATA, 0, data->data,
+                                      data->len);
+    }
+#else
+    (void)wr;
+#endif
+}
+
 static void _cb_rreq_add_addresses(struct rfc5444_writer *wr)
 {
     struct rfc5444_writer_address *orig_prefix;
@@ -110,6 +256,16 @@ static void _cb_rreq_add_addresses(struct rfc5444_writer *wr)
     ipv6_addr_to_netaddr(&_msg.targ_node.addr, pfx_len, &tmp);
     rfc5444_writer_add_address(wr, _rreq_message_content_provider.creator, &tmp, true);
 
+    /* Add the TargPrefixes of a multi-target RREQ */
+    for (unsigned i = 0; i < _msg.num_extra_targs; i++) {
+        pfx_len = _msg.extra_targs[i].pfx_len;
+        if (pfx_len == 0 || pfx_len > 128) {
+            pfx_len = 128;
+        }
+        ipv6_addr_to_netaddr(&_msg.extra_targs[i].addr, pfx_len, &tmp);
+        rfc5444_writer_add_address(wr, _rreq_message_content_provider.creator, &tmp, true);
+    }
+
     /* Add SeqNum TLV and metric TLV to OrigPrefix */
     rfc5444_writer_add_addrtlv(wr, orig_prefix, &_rreq_addrtlvs[RFC5444_MSGTLV_ORIGSEQNUM],
                                &_msg.orig_node.seqnum, sizeof(_msg.orig_node.seqnum),
@@ -160,6 +316,240 @@ static void _cb_rrep_add_addresses(struct rfc5444_writer *wr)
 
     rfc5444_writer_add_addrtlv(wr, targ_prefix, &_rrep_addrtlvs[RFC5444_MSGTLV_METRIC], &targ_node_hopct,
                                sizeof(targ_node_hopct), false);
+
+    /* Add the other TargRouter clients, with their own TLVs */
+    for (unsigned i = 0; i < _msg.num_extra_targs; i++) {
+        pfx_len = _msg.extra_targs[i].pfx_len;
+        if (pfx_len == 0 || pfx_len > 128) {
+            pfx_len = 128;
+        }
+        ipv6_addr_to_netaddr(&_msg.extra_targs[i].addr, pfx_len, &tmp);
+        targ_prefix = rfc5444_writer_add_address(wr, _rrep_message_content_provider.creator, &tmp, true);
+        if (targ_prefix == NULL) {
+            DEBUG_PUTS("aodvv2: couldn't add RREP client prefix");
+            break;
+        }
+
+        rfc5444_writer_add_addrtlv(wr, targ_prefix, &_rrep_addrtlvs[RFC5444_MSGTLV_TARGSEQNUM], &targ_node_seqnum,
+                                   sizeof(targ_node_seqnum), false);
+
+        rfc5444_writer_add_addrtlv(wr, targ_prefix, &_rrep_addrtlvs[RFC5444_MSGTLV_METRIC],
+                                   &_msg.extra_targs[i].metric, sizeof(_msg.extra_targs[i].metric),
+                                   false);
+    }
+}
+
+/**
+ * @brief   Append a single index TLV to a template
+ *
+ * @return Offset of the TLV value.
+ */
+static uint8_t _template_add_tlv(msg_template_t *tpl,
+                                 const struct rfc5444_writer_tlvtype *tlvtype,
+                                 uint8_t idx, uint8_t length)
+{
+    uint8_t *ptr = &tpl->tlvs[tpl->len];
+    uint8_t *flags;
+
+    assert((size_t)(tpl->len + 6 + length) <= sizeof(tpl->tlvs));
+
+    *ptr++ = tlvtype->type;
+    flags = ptr++;
+    *flags = RFC5444_TLV_FLAG_SINGLE_IDX | RFC5444_TLV_FLAG_VALUE;
+    if (tlvtype->exttype) {
+        *flags |= RFC5444_TLV_FLAG_TYPEEXT;
+        *ptr++ = tlvtype->exttype;
+    }
+    *ptr++ = idx;
+    *ptr++ = length;
+
+    uint8_t offset = ptr - tpl->tlvs;
+    memset(ptr, 0, length);
+    tpl->len = offset + length;
+
+    return offset;
+}
+
+static void _template_init(void)
+{
+    /* OrigPrefix (index 0) carries OrigSeqNum and Metric */
+    memset(&_rreq_template, 0, sizeof(_rreq_template));
+    _rreq_template.orig_seqnum =
+        _template_add_tlv(&_rreq_template,
+                          &_rreq_addrtlvs[RFC5444_MSGTLV_ORIGSEQNUM], 0,
+                          sizeof(aodvv2_seqnum_t));
+    _rreq_template.metric =
+        _template_add_tlv(&_rreq_template,
+                          &_rreq_addrtlvs[RFC5444_MSGTLV_METRIC], 0,
+                          sizeof(uint8_t));
+
+    /* OrigPrefix (index 0) carries OrigSeqNum, TargPrefix (index 1)
+     * TargSeqNum and Metric */
+    memset(&_rrep_template, 0, sizeof(_rrep_template));
+    _rrep_template.orig_seqnum =
+        _template_add_tlv(&_rrep_template,
+                          &_rrep_addrtlvs[RFC5444_MSGTLV_ORIGSEQNUM], 0,
+                          sizeof(aodvv2_seqnum_t));
+    _rrep_template.targ_seqnum =
+        _template_add_tlv(&_rrep_template,
+                          &_rrep_addrtlvs[RFC5444_MSGTLV_TARGSEQNUM], 1,
+                          sizeof(aodvv2_seqnum_t));
+    _rrep_template.metric =
+        _template_add_tlv(&_rrep_template,
+                          &_rrep_addrtlvs[RFC5444_MSGTLV_METRIC], 1,
+                          sizeof(uint8_t));
+}
+
+static uint8_t _template_pfx_len(uint8_t pfx_len)
+{
+    return (pfx_len == 0 || pfx_len > 128) ? 128 : pfx_len;
+}
+
+/**
+ * @brief   Write OrigPrefix and TargPrefix as a single address block
+ *
+ * Uses the same head and tail compression the generic writer picks for
+ * two addresses.
+ *
+ * @return Pointer past the address block.
+ * @return NULL if the generic writer has to be used.
+ */
+static uint8_t *_template_write_addrs(uint8_t *ptr, const node_data_t *orig,
+                                      const node_data_t *targ)
+{
+    const uint8_t *a = orig->addr.u8;
+    const uint8_t *b = targ->addr.u8;
+    uint8_t a_pfx_len = _template_pfx_len(orig->pfx_len);
+    uint8_t b_pfx_len = _template_pfx_len(targ->pfx_len);
+    uint8_t head_len = 0;
+    uint8_t tail_len;
+    bool zero_tail = true;
+
+    while (head_len < AODVV2_WRITER_ADDR_LEN && a[head_len] == b[head_len]) {
+        head_len++;
+    }
+
+    /* Equal addresses aren't a common case */
+    if (head_len == AODVV2_WRITER_ADDR_LEN) {
+        return NULL;
+    }
+
+    /* A single common byte doesn't pay off the head length field */
+    if (head_len < 2) {
+        head_len = 0;
+    }
+
+    uint8_t max_tail = AODVV2_WRITER_ADDR_LEN - head_len - 1;
+    for (tail_len = 0; tail_len < max_tail; tail_len++) {
+        uint8_t i = AODVV2_WRITER_ADDR_LEN - tail_len - 1;
+        if (a[i] != b[i]) {
+            break;
+        }
+        zero_tail &= a[i] == 0;
+    }
+
+    uint8_t mid_len = AODVV2_WRITER_ADDR_LEN - head_len - tail_len;
+
+    *ptr++ = 2;
+    uint8_t *flags = ptr++;
+    *flags = 0;
+
+    if (head_len > 0) {
+        *flags |= RFC5444_ADDR_FLAG_HEAD;
+        *ptr++ = head_len;
+        memcpy(ptr, a, head_len);
+        ptr += head_len;
+    }
+
+    if (tail_len > 0) {
+        *ptr++ = tail_len;
+        if (zero_tail) {
+            *flags |= RFC5444_ADDR_FLAG_ZEROTAIL;
+        }
+        else {
+            *flags |= RFC5444_ADDR_FLAG_FULLTAIL;
+            memcpy(ptr, &a[AODVV2_WRITER_ADDR_LEN - tail_len], tail_len);
+            ptr += tail_len;
+        }
+    }
+
+    memcpy(ptr, &a[head_len], mid_len);
+    ptr += mid_len;
+    memcpy(ptr, &b[head_len], mid_len);
+    ptr += mid_len;
+
+    if (a_pfx_len != b_pfx_len) {
+        *flags |= RFC5444_ADDR_FLAG_MULTIPLEN;
+        *ptr++ = a_pfx_len;
+        *ptr++ = b_pfx_len;
+    }
+    else if (a_pfx_len != AODVV2_WRITER_ADDR_LEN * 8) {
+        *flags |= RFC5444_ADDR_FLAG_SINGLEPLEN;
+        *ptr++ = a_pfx_len;
+    }
+
+    return ptr;
+}
+
+/**
+ * @brief   Write a RREQ or RREP from its template
+ *
+ * @return 0 on success.
+ * @return -1 if the generic writer has to be used.
+ */
+static int _template_send(struct rfc5444_writer *wr, uint8_t msg_type,
+                          const msg_template_t *tpl,
+                          const aodvv2_message_t *message,
+                          aodvv2_seqnum_t orig_seqnum,
+                          aodvv2_seqnum_t targ_seqnum, uint8_t metric)
+{
+    /* No message is being created, its buffer is free to build one in */
+    uint8_t *buf = wr->msg_buffer;
+    uint8_t *ptr = buf;
+
+    if (wr->msg_size < AODVV2_WRITER_TEMPLATE_MSG_SIZE) {
+        return -1;
+    }
+
+    /* Message header: no originator, no hop count, no seqno */
+    *ptr++ = msg_type;
+    *ptr++ = RFC5444_MSG_FLAG_HOPLIMIT | (AODVV2_WRITER_ADDR_LEN - 1);
+    ptr += 2;
+    *ptr++ = message->msg_hop_limit;
+
+    /* Empty message TLV block */
+    *ptr++ = 0;
+    *ptr++ = 0;
+
+    ptr = _template_write_addrs(ptr, &message->orig_node,
+                                &message->targ_node);
+    if (ptr == NULL) {
+        return -1;
+    }
+
+    /* Address TLV block */
+    *ptr++ = 0;
+    *ptr++ = tpl->len;
+    memcpy(ptr, tpl->tlvs, tpl->len);
+    memcpy(&ptr[tpl->orig_seqnum], &orig_seqnum, sizeof(orig_seqnum));
+    if (tpl->targ_seqnum != 0) {
+        memcpy(&ptr[tpl->targ_seqnum], &targ_seqnum, sizeof(targ_seqnum));
+    }
+    ptr[tpl->metric] = metric;
+    ptr += tpl->len;
+
+    size_t len = ptr - buf;
+    buf[2] = len >> 8;
+    buf[3] = len & 0xff;
+
+    if (rfc5444_writer_add_binary_msg(wr, buf, len,
+                                      rfc5444_writer_alltargets_selector,
+                                      NULL) != RFC5444_OKAY) {
+        DEBUG_PUTS("aodvv2: template message not added");
+        return -1;
+    }
+
+    return 0;
 }
 
 void aodvv2_writer_init(struct rfc5444_writer *wr)
@@ -193,12 +583,36 @@ void aodvv2_writer_init(struct rfc5444_writer *wr)
         return;
     }
 
+    res = rfc5444_writer_register_msgcontentprovider(wr, &_hello_message_content_provider, _hello_addrtlvs,
+                                                     ARRAY_SIZE(_hello_addrtlvs));
+    if (res < 0) {
+        DEBUG("rfc5444_writer: couldn't register HELLO message provider\n");
+        return;
+    }
+
+    _hello_msg = rfc5444_writer_register_message(wr, RFC6130_MSGTYPE_HELLO, false);
+    if (_hello_msg == NULL) {
+        DEBUG("rfc5444_writer: couldn't register HELLO message\n");
+        return;
+    }
+
     _rreq_msg->addMessageHeader = _cb_add_message_header;
     _rrep_msg->addMessageHeader = _cb_add_message_header;
+    _hello_msg->addMessageHeader = _cb_hello_add_message_header;
+
+    _template_init();
 }
 
 int aodvv2_writer_send_rreq(struct rfc5444_writer *wr, aodvv2_message_t *message)
 {
+    /* The template only covers a single TargPrefix and no message TLVs */
+    if (message->num_extra_targs == 0 && !aodvv2_message_has_data(message) &&
+        _template_send(wr, RFC5444_MSGTYPE_RREQ, &_rreq_template, message,
+                       message->orig_node.seqnum, 0,
+                       message->orig_node.metric) == 0) {
+        return 0;
+    }
+
     memcpy(&_msg, message, sizeof(aodvv2_message_t));
 
     if (rfc5444_writer_create_message_alltarget(wr, RFC5444_MSGTYPE_RREQ,
@@ -210,8 +624,60 @@ int aodvv2_writer_send_rreq(struct rfc5444_writer *wr, aodvv2_message_t *message
     return 0;
 }
 
+int aodvv2_writer_forward_rreq(struct rfc5444_writer *wr,
+                               const aodvv2_message_t *message,
+                               uint8_t *msg, size_t len, size_t metric)
+{
+    assert(wr != NULL && message != NULL && msg != NULL);
+
+    /* Message header */
+    if (len < 4 || msg[0] != RFC5444_MSGTYPE_RREQ ||
+        (((size_t)msg[2] << 8) | msg[3]) != len) {
+        return -EINVAL;
+    }
+
+    uint8_t flags = msg[1];
+    size_t offset = 4;
+
+    if (flags & RFC5444_MSG_FLAG_ORIGINATOR) {
+        offset += (flags & RFC5444_MSG_FLAG_ADDRLENMASK) + 1;
+    }
+
+    if (!(flags & RFC5444_MSG_FLAG_HOPLIMIT) || offset >= len ||
+        metric <= offset || metric >= len) {
+        return -EINVAL;
+    }
+
+    msg[offset++] = message->msg_hop_limit;
+
+    if ((flags & RFC5444_MSG_FLAG_HOPCOUNT) && offset < len &&
+        msg[offset] < UINT8_MAX) {
+        msg[offset]++;
+    }
+
+    msg[metric] = message->orig_node.metric;
+
+    if (rfc5444_writer_add_binary_msg(wr, msg, len,
+                                      rfc5444_writer_alltargets_selector,
+                                      NULL) != RFC5444_OKAY) {
+        DEBUG_PUTS("aodvv2: forwarded RREQ not added");
+        return -EIO;
+    }
+
+    return 0;
+}
+
 int aodvv2_writer_send_rrep(struct rfc5444_writer *wr, aodvv2_message_t *message)
 {
+    /* The template only covers a single TargPrefix */
+    if (message->num_extra_targs == 0 &&
+        _template_send(wr, RFC5444_MSGTYPE_RREP, &_rrep_template, message,
+                       message->orig_node.seqnum, aodvv2_seqnum_get(),
+                       message->targ_node.metric) == 0) {
+        aodvv2_seqnum_inc();
+        return 0;
+    }
+
     memcpy(&_msg, message, sizeof(aodvv2_message_t));
 
     /* TODO: should we use alltarget for RREP? AFAIK we should have
@@ -225,3 +691,27 @@ int aodvv2_writer_send_rrep(struct rfc5444_writer *wr, aodvv2_message_t *message
 
     return 0;
 }
+
+int aodvv2_writer_send_hello(struct rfc5444_writer *wr, uint16_t seqnum,
+                             uint32_t interval, uint32_t validity,
+                             unsigned *state, unsigned max)
+{
+    assert(wr != NULL && state != NULL);
+
+    _hello.start = *state;
+    _hello.end = *state;
+    _hello.max = max;
+    _hello.seqnum = seqnum;
+    _hello.interval = rfc5497_timetlv_encode(interval);
+    _hello.validity = rfc5497_timetlv_encode(validity);
+
+    if (rfc5444_writer_create_message_alltarget(wr, RFC6130_MSGTYPE_HELLO,
+                                                RFC5444_MAX_ADDRLEN) != RFC5444_OKAY) {
+        DEBUG_PUTS("aodvv2: HELLO message not created");
+        return -EIO;
+    }
+
+    *state = _hello.end;
+
+    return 0;
+}
@@ -22,6 +22,7 @@
 #ifndef AODVV2_WRITER_H
 #define AODVV2_WRITER_H
 
+#include "net/aodvv2/neigh.h"
 #include "net/aodvv2/rfc5444.h"
 
 #ifdef __cplusplus
@@ -47,6 +48,26 @@ void aodvv2_writer_init(struct rfc5444_writer *wr);
  */
 int aodvv2_writer_send_rreq(struct rfc5444_writer *wr, aodvv2_message_t *message);
 
+/**
+ * @brief   Forward a received RREQ without re-encoding it
+ *
+ * The hop limit and the OrigNode metric of @p msg are replaced with the ones
+ * on @p message, the hop count is incremented if present.
+ *
+ * @pre (@p wr != NULL) && (@p message != NULL) && (@p msg != NULL)
+ *
+ * @param[in]     wr      The RFC 5444 writer.
+ * @param[in]     message The RREQ message data.
+ * @param[in,out] msg     The received RFC5444 message, patched in place.
+ * @param[in]     len     Length of @p msg.
+ * @param[in]     metric  Offset of the OrigNode metric TLV value on @p msg.
+ *
+ * @return 0 on success, otherwise 0< on failure.
+ */
+int aodvv2_writer_forward_rreq(struct rfc5444_writer *wr,
+                               const aodvv2_message_t *message,
+                               uint8_t *msg, size_t len, size_t metric);
+
 /**
  * @brief   Write a RREP
  *
@@ -59,6 +80,30 @@ int aodvv2_writer_send_rreq(struct rfc5444_writer *wr, aodvv2_message_t *message
  */
 int aodvv2_writer_send_rrep(struct rfc5444_writer *wr, aodvv2_message_t *message);
 
+/**
+ * @brief   Write a HELLO
+ *
+ * Lists up to @p max neighbors of the Neighbor Set from @p state on, with
+ * their link status and the delivery ratio we measured for them, all of
+ * them have to fit in the writer pool.
+ *
+ * @pre (@p wr != NULL) && (@p state != NULL)
+ *
+ * @param[in] wr       The RFC 5444 writer.
+ * @param[in] seqnum   SeqNum of the HELLO.
+ * @param[in] interval Time to the next HELLO in milliseconds.
+ * @param[in] validity Time our neighbors keep us without a HELLO, in
+ *                     milliseconds.
+ * @param[in,out] state State of aodvv2_neigh_hello_next() to list from,
+ *                     updated past the last neighbor listed.
+ * @param[in] max      Maximum number of neighbors to list.
+ *
+ * @return 0 on success, otherwise 0< on failure.
+ */
+int aodvv2_writer_send_hello(struct rfc5444_writer *wr, uint16_t seqnum,
+                             uint32_t interval, uint32_t validity,
+                             unsigned *state, unsigned max);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
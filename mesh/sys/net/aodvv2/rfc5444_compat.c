@@ -40,7 +40,7 @@ void ipv6_addr_to_netaddr(const ipv6_addr_t *src, uint8_t pfx_len,
     memcpy(dst->_addr, src, sizeof(dst->_addr));
 }
 
-void netaddr_to_ipv6_addr(struct netaddr *src, ipv6_addr_t *dst,
+void netaddr_to_ipv6_addr(const struct netaddr *src, ipv6_addr_t *dst,
                           uint8_t *pfx_len)
 {
     assert(src != NULL && dst != NULL);
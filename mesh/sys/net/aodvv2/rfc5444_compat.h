@@ -49,7 +49,7 @@ void ipv6_addr_to_netaddr(const ipv6_addr_t *src, uint8_t pfx_len, struct netadd
  * @param[out] dst     Destination.
  * @param[out] pfx_len Prefix length.
  */
-void netaddr_to_ipv6_addr(struct netaddr *src, ipv6_addr_t *dst, uint8_t *pfx_len);
+void netaddr_to_ipv6_addr(const struct netaddr *src, ipv6_addr_t *dst, uint8_t *pfx_len);
 
 #ifdef __cplusplus
 } /* extern "C" */
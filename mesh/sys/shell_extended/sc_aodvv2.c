@@ -26,9 +26,13 @@
 
 #if IS_USED(MODULE_AODVV2)
 
+#include <inttypes.h>
 #include <stdio.h>
 
+#include "net/aodvv2.h"
 #include "net/aodvv2/rcs.h"
+#include "net/aodvv2/timers.h"
+#include "rfc5444/rfc5444_pool.h"
 
 /** Default prefix length if not specified */
 #define _IPV6_DEFAULT_PREFIX_LEN (64U)
@@ -74,10 +78,69 @@ static int _rcs_add(int argc, char **argv)
     return 0;
 }
 
+static void _batch_print_hist(const char *name, const uint32_t *hist)
+{
+    printf("%s:", name);
+    for (unsigned i = 0; i < AODVV2_BATCH_HIST_BUCKETS; i++) {
+        printf(" %u%s: %" PRIu32, 1U << i,
+               i == (AODVV2_BATCH_HIST_BUCKETS - 1) ? "+" : "", hist[i]);
+    }
+    puts("");
+}
+
+static void _batch_print(void)
+{
+    aodvv2_batch_stats_t stats;
+    aodvv2_batch_stats_get(&stats);
+
+    _batch_print_hist("queue depth", stats.queue_depth);
+    _batch_print_hist("batch size", stats.batch_size);
+}
+
+static void _pool_print_stats(const char *name,
+                              const struct rfc5444_pool_stats *stats)
+{
+    printf("%s: %u/%u used, %u max, %" PRIu32 " exhausted\n", name,
+           stats->used, stats->size, stats->max_used, stats->exhausted);
+}
+
+static void _pool_print(void)
+{
+    struct rfc5444_reader_pool_stats stats;
+    aodvv2_reader_pool_stats_get(&stats);
+
+    _pool_print_stats("reader tlvs", &stats.tlvs);
+    _pool_print_stats("reader addrs", &stats.addrs);
+
+    struct rfc5444_writer_pool_stats wstats;
+    rfc5444_writer_pool_get_stats(&wstats);
+
+    _pool_print_stats("writer addrs", &wstats.addrs);
+    _pool_print_stats("writer addrtlvs", &wstats.addrtlvs);
+    _pool_print_stats("writer msgs", &wstats.msgs);
+}
+
+static void _timers_print(void)
+{
+    aodvv2_timers_t timers;
+    aodvv2_timers_get(&timers);
+
+    printf("scale: %u%%%s\n", timers.scale,
+           IS_ACTIVE(CONFIG_AODVV2_ADAPTIVE_TIMERS) ? "" : " (fixed)");
+    printf("MAX_IDLETIME: %u s (max %u s)\n", timers.max_idletime,
+           (unsigned)CONFIG_AODVV2_MAX_IDLETIME);
+    printf("route lifetime: %u s\n", aodvv2_timers_route_lifetime());
+    printf("MAX_SEQNUM_LIFETIME: %u s (max %u s)\n",
+           timers.max_seqnum_lifetime,
+           (unsigned)CONFIG_AODVV2_MAX_SEQNUM_LIFETIME);
+    printf("interval: %u routes broken, %u/%u discoveries done\n",
+           timers.breaks, timers.discoveries_done, timers.discoveries);
+}
+
 int sc_aodvv2_cmd(int argc, char **argv)
 {
     if (argc < 2) {
-        printf("usage: %s [rcs]\n", argv[0]);
+        printf("usage: %s [rcs|batch|pool|timers]\n", argv[0]);
         return 1;
     }
 
@@ -85,6 +148,23 @@ int sc_aodvv2_cmd(int argc, char **argv)
         if (argc == 2) {
             aodvv2_rcs_print_entries();
         }
+        else if (strcmp(argv[2], "gateway") == 0) {
+            if (argc > 3 && strcmp(argv[3], "del") == 0) {
+                aodvv2_rcs_gateway_del();
+                printf("success: removed gateway prefix from the RCS\n");
+            }
+            else if (argc > 3) {
+                printf("usage: %s rcs gateway [del]\n", argv[0]);
+                return 1;
+            }
+            else if (aodvv2_rcs_gateway_add(1) == NULL) {
+                printf("error: unable to add gateway prefix to RCS\n");
+                return 1;
+            }
+            else {
+                printf("success: added gateway prefix to the RCS\n");
+            }
+        }
         else if (strcmp(argv[2], "add") == 0) {
             if (argc < 4) {
                 _rcs_add_usage(argv[0]);
@@ -97,6 +177,15 @@ int sc_aodvv2_cmd(int argc, char **argv)
             puts("error: invalid command");
         }
     }
+    else if (strcmp(argv[1], "batch") == 0) {
+        _batch_print();
+    }
+    else if (strcmp(argv[1], "pool") == 0) {
+        _pool_print();
+    }
+    else if (strcmp(argv[1], "timers") == 0) {
+        _timers_print();
+    }
     else {
         puts("error: invalid command");
     }